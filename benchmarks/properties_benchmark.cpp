@@ -0,0 +1,266 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/plain_property.h>
+#include <core/pooled_signal.h>
+#include <core/property.h>
+#include <core/sharded_signal.h>
+#include <core/signal.h>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace
+{
+// Counts all allocations of the process, reported per operation by the benchmarks below.
+std::atomic<std::size_t> allocation_count{0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* p = std::malloc(size))
+        return p;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+// Reports the allocations made while an instance is alive as allocations per iteration.
+struct AllocationCounter
+{
+    AllocationCounter(benchmark::State& state)
+        : state(state),
+          allocations_at_start(allocation_count.load())
+    {
+    }
+
+    ~AllocationCounter()
+    {
+        state.counters["allocations_per_op"] = benchmark::Counter(
+                    static_cast<double>(allocation_count.load() - allocations_at_start),
+                    benchmark::Counter::kAvgIterations);
+    }
+
+    benchmark::State& state;
+    std::size_t allocations_at_start;
+};
+
+void emit_with_slot_count(benchmark::State& state)
+{
+    core::Signal<int> s;
+
+    int sum = 0;
+    for (int i = 0; i < state.range(0); i++)
+        s.connect([&sum](int value) { sum += value; });
+
+    {
+        AllocationCounter counter{state};
+        for (auto _ : state)
+        {
+            s(1);
+            benchmark::DoNotOptimize(sum);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void keyed_emit_with_slot_count(benchmark::State& state)
+{
+    core::Signal<int, int> s;
+
+    int sum = 0;
+    for (int i = 0; i < state.range(0); i++)
+        s.connect_keyed(i, [&sum](int, int value) { sum += value; });
+
+    {
+        AllocationCounter counter{state};
+        int key = 0;
+        for (auto _ : state)
+        {
+            s(key, 1);
+            key = (key + 1) % static_cast<int>(state.range(0));
+            benchmark::DoNotOptimize(sum);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void connect_and_disconnect_with_slot_count(benchmark::State& state)
+{
+    core::Signal<int> s;
+
+    std::vector<core::Connection> connections;
+    for (int i = 0; i < state.range(0); i++)
+        connections.push_back(s.connect([](int) {}));
+
+    AllocationCounter counter{state};
+    for (auto _ : state)
+    {
+        auto connection = s.connect([](int) {});
+        connection.disconnect();
+    }
+}
+
+void pooled_connect_and_disconnect_with_slot_count(benchmark::State& state)
+{
+    core::PooledSignal<int> s;
+
+    std::vector<core::Connection> connections;
+    for (int i = 0; i < state.range(0); i++)
+        connections.push_back(s.connect([](int) {}));
+
+    AllocationCounter counter{state};
+    for (auto _ : state)
+    {
+        auto connection = s.connect([](int) {});
+        connection.disconnect();
+    }
+}
+
+void emit_from_multiple_threads(benchmark::State& state)
+{
+    static core::Signal<int> s;
+    static std::atomic<int> sum{0};
+    static core::Connection connection = s.connect([](int value) { sum.fetch_add(value, std::memory_order_relaxed); });
+
+    for (auto _ : state)
+        s(1);
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+// The slot only touches thread-local data, such that any contention is due to the signal itself.
+void sharded_emit_from_multiple_threads(benchmark::State& state)
+{
+    static core::ShardedSignal<int> s;
+    static core::Connection connection = s.connect([](int value)
+    {
+        static thread_local int sum = 0;
+        sum += value;
+        benchmark::DoNotOptimize(sum);
+    });
+
+    for (auto _ : state)
+        s(1);
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void property_set_without_observers(benchmark::State& state)
+{
+    core::Property<int> p;
+
+    AllocationCounter counter{state};
+    int value = 0;
+    for (auto _ : state)
+        p.set(++value);
+}
+
+void plain_property_set_without_observers(benchmark::State& state)
+{
+    core::PlainProperty<int> p;
+
+    AllocationCounter counter{state};
+    int value = 0;
+    for (auto _ : state)
+        p.set(++value);
+}
+
+void raw_field_write(benchmark::State& state)
+{
+    int field = 0;
+    int value = 0;
+    for (auto _ : state)
+    {
+        field = ++value;
+        benchmark::DoNotOptimize(field);
+    }
+}
+
+void property_set_with_observers(benchmark::State& state)
+{
+    core::Property<int> p;
+
+    int sum = 0;
+    for (int i = 0; i < state.range(0); i++)
+        p.changed().connect([&sum](int value) { sum += value; });
+
+    {
+        AllocationCounter counter{state};
+        int value = 0;
+        for (auto _ : state)
+        {
+            p.set(++value);
+            benchmark::DoNotOptimize(sum);
+        }
+    }
+}
+
+void property_chain_propagation(benchmark::State& state)
+{
+    std::vector<std::unique_ptr<core::Property<int>>> chain;
+    for (int i = 0; i <= state.range(0); i++)
+        chain.emplace_back(new core::Property<int>());
+
+    for (int i = 0; i < state.range(0); i++)
+        *chain[i] | *chain[i + 1];
+
+    {
+        AllocationCounter counter{state};
+        int value = 0;
+        for (auto _ : state)
+            chain.front()->set(++value);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+}
+
+BENCHMARK(emit_with_slot_count)->Arg(0)->Arg(1)->Arg(4)->Arg(8)->Arg(64)->Arg(1024);
+BENCHMARK(keyed_emit_with_slot_count)->Arg(1)->Arg(64)->Arg(2048);
+BENCHMARK(connect_and_disconnect_with_slot_count)->Arg(0)->Arg(4)->Arg(64)->Arg(1024);
+BENCHMARK(pooled_connect_and_disconnect_with_slot_count)->Arg(0)->Arg(4)->Arg(64)->Arg(1024);
+BENCHMARK(emit_from_multiple_threads)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(sharded_emit_from_multiple_threads)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(property_set_without_observers);
+BENCHMARK(plain_property_set_without_observers);
+BENCHMARK(raw_field_write);
+BENCHMARK(property_set_with_observers)->Arg(1)->Arg(4)->Arg(64);
+BENCHMARK(property_chain_propagation)->Arg(1)->Arg(8)->Arg(64);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,80 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/signal.h>
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+// Mirrors the previous slot storage of core::Signal: a mutex-guarded
+// std::list of slot wrappers that is walked for every emission.
+struct ListSignal
+{
+    struct SlotWrapper
+    {
+        std::function<void(int)> slot;
+        core::Connection::Dispatcher dispatcher;
+        std::size_t id;
+    };
+
+    void connect(const std::function<void(int)>& slot)
+    {
+        std::lock_guard<std::mutex> lg(guard);
+        slot_list.push_back(SlotWrapper{slot, core::Connection::Dispatcher{}, slot_list.size()});
+    }
+
+    void operator()(int value)
+    {
+        std::lock_guard<std::mutex> lg(guard);
+        for (const auto& slot : slot_list)
+            slot.slot(value);
+    }
+
+    std::mutex guard;
+    std::list<SlotWrapper> slot_list;
+};
+
+template<typename SignalType>
+void emit(benchmark::State& state)
+{
+    SignalType s;
+
+    int sum = 0;
+    for (int i = 0; i < state.range(0); i++)
+        s.connect([&sum](int value) { sum += value; });
+
+    for (auto _ : state)
+    {
+        s(1);
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+}
+
+BENCHMARK_TEMPLATE(emit, core::Signal<int>)->Arg(1)->Arg(4)->Arg(64)->Arg(1024);
+BENCHMARK_TEMPLATE(emit, ListSignal)->Arg(1)->Arg(4)->Arg(64)->Arg(1024);
+
+BENCHMARK_MAIN();
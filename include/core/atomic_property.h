@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_ATOMIC_PROPERTY_H_
+#define CORE_ATOMIC_PROPERTY_H_
+
+#include <core/signal.h>
+
+#include <atomic>
+#include <functional>
+#include <type_traits>
+
+namespace core
+{
+/**
+ * @brief A thread-safe property for trivially copyable values, backed by std::atomic.
+ *
+ * Reads never block and are wait-free whenever std::atomic<T> is lock-free, see is_lock_free().
+ * Writes compare-exchange the contained value and emit the changed signal only if they
+ * actually changed it. The signal is emitted on the writing thread after the new value has
+ * been published. With concurrent writers, observers might thus see notifications in a
+ * different order than the values have been stored.
+ *
+ * @tparam T The type of the value contained within the property, has to be trivially copyable.
+ */
+template<typename T>
+class AtomicProperty
+{
+    static_assert(std::is_trivially_copyable<T>::value, "AtomicProperty requires a trivially copyable type");
+
+  public:
+    /**
+     * @brief ValueType refers to the type of the contained value.
+     */
+    typedef T ValueType;
+
+    /**
+     * @brief AtomicProperty creates a new instance and initializes the contained value.
+     * @param t The initial value.
+     */
+    inline explicit AtomicProperty(const T& t = T{}) : value{t}
+    {
+    }
+
+    /**
+     * @brief Copy c'tor, only copies the contained value, not the changed signal and its connections.
+     * @param rhs
+     */
+    inline AtomicProperty(const AtomicProperty<T>& rhs) : value{rhs.get()}
+    {
+    }
+
+    /**
+     * @brief Assignment operator, only assigns to the contained value.
+     * @param rhs The right-hand-side, raw value to assign to this property.
+     */
+    inline AtomicProperty& operator=(const T& rhs)
+    {
+        set(rhs);
+        return *this;
+    }
+
+    /**
+     * @brief Assignment operator, only assigns to the contained value, not the changed signal and its connections.
+     * @param rhs The right-hand-side property to assign from.
+     */
+    inline AtomicProperty& operator=(const AtomicProperty<T>& rhs)
+    {
+        set(rhs.get());
+        return *this;
+    }
+
+    /**
+     * @brief Explicit casting operator to the contained value type.
+     * @return A copy of the contained value.
+     */
+    inline operator T() const
+    {
+        return get();
+    }
+
+    /**
+     * @brief Checks if reads and writes of this property are lock-free on this platform.
+     */
+    inline bool is_lock_free() const
+    {
+        return value.is_lock_free();
+    }
+
+    /**
+     * @brief Access the value contained within this property. Thread-safe, never blocks.
+     * @return A copy of the property value.
+     */
+    inline T get() const
+    {
+        return value.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Set the contained value to the provided value. Notify observers of the change. Thread-safe.
+     * @param [in] new_value The new value to assign to this property.
+     * @return true iff the contained value has been changed by this call.
+     */
+    inline bool set(const T& new_value)
+    {
+        T current = value.load(std::memory_order_relaxed);
+
+        do
+        {
+            if (current == new_value)
+                return false;
+        } while (!value.compare_exchange_weak(current, new_value, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        signal_changed(new_value);
+        return true;
+    }
+
+    /**
+     * @brief Atomically applies the update functor to the contained value. Thread-safe.
+     *
+     * The functor operates on a copy of the current value and might be invoked repeatedly
+     * if other writers modify the property concurrently. If it returns true, the updated
+     * copy is stored and the changed signal is emitted.
+     *
+     * @param update_functor The update function to be applied to the contained value.
+     * @return true iff application of the update functor has been successful.
+     */
+    inline bool update(const std::function<bool(T& t)>& update_functor)
+    {
+        T current = value.load(std::memory_order_relaxed);
+        T updated;
+
+        do
+        {
+            updated = current;
+            if (!update_functor(updated))
+                return false;
+        } while (!value.compare_exchange_weak(current, updated, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        signal_changed(updated);
+        return true;
+    }
+
+    /**
+     * @brief Access to the changed signal, allows observers to subscribe to change notifications.
+     * @return A non-mutable reference to the changed signal.
+     */
+    inline const Signal<T>& changed() const
+    {
+        return signal_changed;
+    }
+
+  private:
+    std::atomic<T> value;
+    Signal<T> signal_changed;
+};
+}
+
+#endif // CORE_ATOMIC_PROPERTY_H_
@@ -0,0 +1,292 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_BINDING_GRAPH_H_
+#define CORE_BINDING_GRAPH_H_
+
+#include <core/computed_property.h>
+#include <core/connection_group.h>
+#include <core/property.h>
+
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+/**
+ * @brief Propagates changes between bound properties in topological order, free of glitches.
+ *
+ * Chaining properties via operator| forwards every change right away, hop by hop on the
+ * stack. In a diamond-shaped graph, nodes with several inputs are thus updated once per
+ * input and observe inconsistent intermediate states. A binding graph tracks all of its
+ * bindings instead and, on a change, updates every affected node exactly once, after all
+ * of its inputs have been updated, iteratively and with constant stack depth. Nodes whose
+ * value did not change in the course of a propagation do not trigger their outputs.
+ *
+ * Sources can be properties or computed properties, the latter being evaluated on demand
+ * when a node reading them is updated. A node is the target of at most one binding, and
+ * bindings that would introduce a cycle are rejected.
+ *
+ * A note on thread-safety: Just like Property, this class does not give any thread-safety guarantees.
+ * All properties known to a graph have to outlive it.
+ */
+class BindingGraph
+{
+  public:
+    inline BindingGraph() : propagating{false}
+    {
+    }
+
+    BindingGraph(const BindingGraph&) = delete;
+    BindingGraph& operator=(const BindingGraph&) = delete;
+
+    /**
+     * @brief Binds target to source, target receives every new value of source.
+     * @return false iff target is already bound or the binding would introduce a cycle.
+     */
+    template<typename Source, typename T, typename EqualityPolicy>
+    inline bool bind(const Source& source, Property<T, EqualityPolicy>& target)
+    {
+        return compute(target, Identity{}, source);
+    }
+
+    /**
+     * @brief Binds target to source, target receives every new value of source as transformed by the converter.
+     * @param converter Converts a value of source to a value of target.
+     * @return false iff target is already bound or the binding would introduce a cycle.
+     */
+    template<typename Source, typename T, typename EqualityPolicy, typename Converter>
+    inline bool bind(const Source& source, Property<T, EqualityPolicy>& target, Converter converter)
+    {
+        return compute(target, converter, source);
+    }
+
+    /**
+     * @brief Binds target to several sources, target is assigned computation(sources.get()...).
+     *
+     * The computation is invoked at most once per propagation, after all of the sources
+     * have been updated.
+     *
+     * @return false iff target is already bound or the binding would introduce a cycle.
+     */
+    template<typename T, typename EqualityPolicy, typename Computation, typename... Sources>
+    inline bool compute(Property<T, EqualityPolicy>& target, Computation computation, const Sources&... sources)
+    {
+        std::size_t id = node_for(target);
+        std::vector<std::size_t> inputs{node_for(sources)...};
+
+        if (nodes[id].update || reaches_any(id, inputs))
+            return false;
+
+        for (auto input : inputs)
+            nodes[input].outputs.push_back(id);
+
+        nodes[id].update = [&target, computation, &sources...]()
+        {
+            T new_value(computation(sources.get()...));
+            target.set(std::move(new_value));
+        };
+
+        rank_node(id, inputs);
+        return true;
+    }
+
+    /**
+     * @brief Queries the number of properties known to this graph.
+     */
+    inline std::size_t size() const
+    {
+        return nodes.size();
+    }
+
+  private:
+    struct Identity
+    {
+        template<typename U>
+        inline const U& operator()(const U& u) const
+        {
+            return u;
+        }
+    };
+
+    struct Node
+    {
+        std::function<void()> update;
+        std::vector<std::size_t> outputs;
+        std::size_t rank = 0;
+        bool queued = false;
+    };
+
+    // Adapts arbitrary change signals to notifying this graph.
+    struct Listener
+    {
+        template<typename... Args>
+        inline void operator()(const Args&...) const
+        {
+            graph->changed(node);
+        }
+
+        BindingGraph* graph;
+        std::size_t node;
+    };
+
+    // Resets the propagation state even if an update throws.
+    struct PropagationScope
+    {
+        inline explicit PropagationScope(BindingGraph& graph) : graph(graph)
+        {
+            graph.propagating = true;
+        }
+
+        inline ~PropagationScope()
+        {
+            while (!graph.pending.empty())
+            {
+                graph.nodes[graph.pending.top().second].queued = false;
+                graph.pending.pop();
+            }
+
+            graph.propagating = false;
+        }
+
+        BindingGraph& graph;
+    };
+
+    typedef std::pair<std::size_t, std::size_t> Pending;
+
+    template<typename U, typename EqualityPolicy>
+    inline Connection watch(const Property<U, EqualityPolicy>& property, std::size_t id)
+    {
+        return property.changed().connect(Listener{this, id});
+    }
+
+    template<typename U>
+    inline Connection watch(const ComputedProperty<U>& property, std::size_t id)
+    {
+        return property.invalidated().connect(Listener{this, id});
+    }
+
+    template<typename Observable>
+    inline std::size_t node_for(const Observable& observable)
+    {
+        auto it = ids.find(&observable);
+        if (it != ids.end())
+            return it->second;
+
+        std::size_t id = nodes.size();
+        nodes.emplace_back();
+        ids.emplace(&observable, id);
+        connections.add(watch(observable, id));
+
+        return id;
+    }
+
+    // Checks if any of the targets can be reached from id, or equals id.
+    inline bool reaches_any(std::size_t id, const std::vector<std::size_t>& targets) const
+    {
+        for (auto target : targets)
+            if (id == target)
+                return true;
+
+        if (nodes[id].outputs.empty())
+            return false;
+
+        std::vector<bool> visited(nodes.size(), false);
+        std::vector<std::size_t> stack{id};
+
+        while (!stack.empty())
+        {
+            std::size_t current = stack.back();
+            stack.pop_back();
+
+            for (auto target : targets)
+                if (current == target)
+                    return true;
+
+            if (visited[current])
+                continue;
+
+            visited[current] = true;
+            stack.insert(stack.end(), nodes[current].outputs.begin(), nodes[current].outputs.end());
+        }
+
+        return false;
+    }
+
+    // Raises the rank of id above all of its inputs, and the ranks of everything downstream of it.
+    inline void rank_node(std::size_t id, const std::vector<std::size_t>& inputs)
+    {
+        for (auto input : inputs)
+            if (nodes[id].rank < nodes[input].rank + 1)
+                nodes[id].rank = nodes[input].rank + 1;
+
+        std::vector<std::size_t> stack{id};
+        while (!stack.empty())
+        {
+            std::size_t current = stack.back();
+            stack.pop_back();
+
+            for (auto output : nodes[current].outputs)
+            {
+                if (nodes[output].rank >= nodes[current].rank + 1)
+                    continue;
+
+                nodes[output].rank = nodes[current].rank + 1;
+                stack.push_back(output);
+            }
+        }
+    }
+
+    inline void changed(std::size_t id)
+    {
+        for (auto output : nodes[id].outputs)
+        {
+            if (nodes[output].queued)
+                continue;
+
+            nodes[output].queued = true;
+            pending.push(Pending{nodes[output].rank, output});
+        }
+
+        // Updates triggered by a propagation in progress are picked up by its loop.
+        if (propagating)
+            return;
+
+        PropagationScope scope{*this};
+        while (!pending.empty())
+        {
+            std::size_t next = pending.top().second;
+            pending.pop();
+
+            nodes[next].queued = false;
+            nodes[next].update();
+        }
+    }
+
+    std::vector<Node> nodes;
+    std::unordered_map<const void*, std::size_t> ids;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+    bool propagating;
+    ConnectionGroup connections;
+};
+}
+
+#endif // CORE_BINDING_GRAPH_H_
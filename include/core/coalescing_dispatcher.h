@@ -0,0 +1,224 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_COALESCING_DISPATCHER_H_
+#define CORE_COALESCING_DISPATCHER_H_
+
+#include <core/connection.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+/**
+ * @brief Wraps a queueing dispatcher such that at most one invocation per connection is pending.
+ *
+ * Emissions that arrive while an invocation is still queued replace the arguments of that
+ * invocation instead of queueing another one: the latest value wins, stale values are dropped.
+ * Every call to coalesce() yields an independent adaptor, to be installed on a single
+ * connection via Connection::dispatch_via.
+ *
+ * @param downstream The dispatcher the coalesced invocations are queued on.
+ * @return An adaptor suitable for Connection::dispatch_via.
+ */
+inline Connection::Dispatcher coalesce(const Connection::Dispatcher& downstream)
+{
+    struct State
+    {
+        std::mutex guard;
+        std::function<void()> pending;
+        bool scheduled = false;
+    };
+
+    auto state = std::make_shared<State>();
+
+    return [downstream, state](const std::function<void()>& handler)
+    {
+        {
+            std::lock_guard<std::mutex> lg(state->guard);
+            state->pending = handler;
+
+            if (state->scheduled)
+                return;
+
+            state->scheduled = true;
+        }
+
+        downstream([state]()
+        {
+            std::function<void()> handler;
+            {
+                std::lock_guard<std::mutex> lg(state->guard);
+                handler = std::move(state->pending);
+                state->pending = nullptr;
+                state->scheduled = false;
+            }
+
+            handler();
+        });
+    };
+}
+
+/**
+ * @brief A dispatcher that holds the latest invocation of every connection until the next tick.
+ *
+ * Connections dispatched via an adaptor returned by dispatcher() park their most recent
+ * invocation in a pending slot, replacing whatever was pending before. Calling flush(),
+ * e.g. once per frame of a UI, delivers all pending invocations. An optional minimum
+ * interval limits the rate at which every single connection is delivered: invocations
+ * arriving faster stay pending, and only the latest of them is delivered once the interval
+ * has elapsed.
+ *
+ * Dispatching is thread-safe, flush() is meant to be called from a single thread at a time.
+ */
+class CoalescingDispatcher
+{
+public:
+    /**
+     * @brief Handler refers to the function type executed on flush.
+     */
+    typedef std::function<void()> Handler;
+
+    /**
+     * @brief Clock refers to the clock the minimum interval is measured with.
+     */
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief CoalescingDispatcher creates a new instance.
+     * @param min_interval The minimum time between two deliveries for the same connection.
+     */
+    inline explicit CoalescingDispatcher(const Clock::duration& min_interval = Clock::duration::zero())
+        : min_interval(min_interval)
+    {
+    }
+
+    CoalescingDispatcher(const CoalescingDispatcher&) = delete;
+    CoalescingDispatcher& operator=(const CoalescingDispatcher&) = delete;
+
+    /**
+     * @brief Returns an adaptor with its own pending slot, suitable for Connection::dispatch_via.
+     *
+     * Every connection should be given an adaptor of its own. The adaptor refers to this
+     * instance, which has to outlive all connections using it. The pending slot lives as
+     * long as the adaptor does, an invocation still pending once the adaptor is gone is
+     * dropped.
+     */
+    inline Connection::Dispatcher dispatcher()
+    {
+        std::shared_ptr<PendingSlot> slot{new PendingSlot()};
+
+        {
+            std::lock_guard<std::mutex> lg(guard);
+
+            prune();
+            slots.push_back(slot);
+        }
+
+        return [this, slot](const Handler& handler)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            slot->handler = handler;
+        };
+    }
+
+    /**
+     * @brief Queries the number of connections with a pending invocation.
+     */
+    inline std::size_t pending() const
+    {
+        std::lock_guard<std::mutex> lg(guard);
+
+        std::size_t result = 0;
+        for (const auto& weak : slots)
+            if (auto slot = weak.lock())
+                if (slot->handler)
+                    result++;
+
+        return result;
+    }
+
+    /**
+     * @brief Delivers the pending invocation of every connection whose minimum interval has elapsed.
+     * @return The number of invocations delivered.
+     */
+    inline std::size_t flush()
+    {
+        auto now = Clock::now();
+
+        std::vector<Handler> due;
+        {
+            std::lock_guard<std::mutex> lg(guard);
+
+            prune();
+
+            for (const auto& weak : slots)
+            {
+                auto slot = weak.lock();
+                if (!slot || !slot->handler)
+                    continue;
+
+                if (slot->delivered && now - slot->last_delivery < min_interval)
+                    continue;
+
+                due.push_back(std::move(slot->handler));
+                slot->handler = nullptr;
+                slot->delivered = true;
+                slot->last_delivery = now;
+            }
+        }
+
+        for (const auto& handler : due)
+            handler();
+
+        return due.size();
+    }
+
+private:
+    struct PendingSlot
+    {
+        Handler handler;
+        bool delivered = false;
+        Clock::time_point last_delivery;
+    };
+
+    // Drops the slots of adaptors that have been destroyed, guard has to be held by the caller.
+    inline void prune()
+    {
+        slots.erase(
+                    std::remove_if(
+                        slots.begin(),
+                        slots.end(),
+                        [](const std::weak_ptr<PendingSlot>& slot) { return slot.expired(); }),
+                    slots.end());
+    }
+
+    const Clock::duration min_interval;
+    mutable std::mutex guard;
+    // Slots are owned by their adaptors.
+    std::vector<std::weak_ptr<PendingSlot>> slots;
+};
+}
+
+#endif // CORE_COALESCING_DISPATCHER_H_
@@ -0,0 +1,313 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_COLLECTION_PROPERTY_H_
+#define CORE_COLLECTION_PROPERTY_H_
+
+#include <core/property.h>
+
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+/**
+ * @brief The kinds of element-level changes reported by a CollectionProperty.
+ */
+enum class CollectionOperation
+{
+    /** @brief An element has been inserted at key. */
+    insert,
+    /** @brief The element at key has been erased, value carries the erased element. */
+    erase,
+    /** @brief The element at key has been replaced by value. */
+    replace,
+    /** @brief The whole collection has been assigned, key and value are default-constructed. */
+    reset
+};
+
+/**
+ * @brief Describes a single element-level change of a CollectionProperty.
+ * @tparam Key Identifies an element, an index for sequences or a key for maps.
+ * @tparam Value The element type.
+ */
+template<typename Key, typename Value>
+struct CollectionDelta
+{
+    CollectionOperation operation;
+    Key key;
+    Value value;
+};
+
+/**
+ * @brief A property holding a collection that reports changes element by element.
+ *
+ * Besides the changed signal inherited from Property, which carries the whole collection,
+ * collection properties emit compact deltas on a dedicated signal. Mutating single elements
+ * through the API of the collection property costs O(1) comparisons and a delta
+ * notification, independent of the size of the collection. Assigning the collection as a
+ * whole via set() still compares it in full and is reported as CollectionOperation::reset.
+ *
+ * Element-level mutations go through the same path as set(): an installed setter receives
+ * the whole, updated collection before the delta and the changed signal are emitted.
+ * Elements are compared via operator==, replacing an element by an equal one changes nothing.
+ *
+ * Deltas are emitted immediately, also within a core::Transaction, while the changed
+ * signal coalesces just like for any other property.
+ *
+ * Specializations exist for std::vector, std::map and std::unordered_map.
+ *
+ * @tparam Container The type of the collection.
+ */
+template<typename Container>
+class CollectionProperty;
+
+namespace detail
+{
+// The parts shared by all collection properties.
+template<typename Container, typename Key, typename Value>
+class CollectionPropertyBase : public Property<Container>
+{
+  public:
+    typedef CollectionDelta<Key, Value> Delta;
+
+    inline explicit CollectionPropertyBase(const Container& container) : Property<Container>(container)
+    {
+    }
+
+    /**
+     * @brief Access to the delta signal, allows observers to subscribe to element-level changes.
+     */
+    inline const Signal<const Delta&>& delta() const
+    {
+        return signal_delta;
+    }
+
+    /**
+     * @brief Queries the number of elements in the collection.
+     */
+    inline std::size_t size() const
+    {
+        return this->get().size();
+    }
+
+    using Property<Container>::set;
+
+    inline void set(const Container& new_value) override
+    {
+        if (this->mutable_get() == new_value)
+            return;
+
+        this->assign(new_value);
+        signal_delta(Delta{CollectionOperation::reset, Key{}, Value{}});
+    }
+
+    inline bool update(const std::function<bool(Container& t)>& update_functor) override
+    {
+        if (!Property<Container>::update(update_functor))
+            return false;
+
+        signal_delta(Delta{CollectionOperation::reset, Key{}, Value{}});
+        return true;
+    }
+
+  protected:
+    // Reports an element-level mutation of the collection, modified in place.
+    inline void notify(CollectionOperation operation, const Key& key, const Value& value)
+    {
+        this->dispatch_to_setter();
+        signal_delta(Delta{operation, key, value});
+        this->notify_changed();
+    }
+
+  private:
+    Signal<const Delta&> signal_delta;
+};
+
+// Maps of all flavors share their mutation API.
+template<typename Map>
+class MapCollectionProperty
+        : public CollectionPropertyBase<Map, typename Map::key_type, typename Map::mapped_type>
+{
+  public:
+    typedef typename Map::key_type Key;
+    typedef typename Map::mapped_type Value;
+
+    inline explicit MapCollectionProperty(const Map& map)
+        : CollectionPropertyBase<Map, Key, Value>(map)
+    {
+    }
+
+    /**
+     * @brief Inserts the value for key, or replaces the element stored for key.
+     * @return true iff the collection has been changed.
+     */
+    inline bool insert_or_assign(const Key& key, const Value& value)
+    {
+        auto& map = this->mutable_get();
+
+        auto it = map.find(key);
+        if (it == map.end())
+        {
+            map.emplace(key, value);
+            this->notify(CollectionOperation::insert, key, value);
+            return true;
+        }
+
+        if (it->second == value)
+            return false;
+
+        it->second = value;
+        this->notify(CollectionOperation::replace, key, value);
+        return true;
+    }
+
+    /**
+     * @brief Erases the element stored for key, if any.
+     * @return true iff an element has been erased.
+     */
+    inline bool erase(const Key& key)
+    {
+        auto& map = this->mutable_get();
+
+        auto it = map.find(key);
+        if (it == map.end())
+            return false;
+
+        Value erased = std::move(it->second);
+        map.erase(it);
+
+        this->notify(CollectionOperation::erase, key, erased);
+        return true;
+    }
+};
+}
+
+/**
+ * @brief A collection property for std::vector, elements are identified by their index.
+ *
+ * Indices reported for insertions and erasures refer to the collection right after the change.
+ */
+template<typename T, typename Allocator>
+class CollectionProperty<std::vector<T, Allocator>>
+        : public detail::CollectionPropertyBase<std::vector<T, Allocator>, std::size_t, T>
+{
+  public:
+    typedef std::vector<T, Allocator> ValueType;
+
+    /**
+     * @brief CollectionProperty creates a new instance and initializes the contained collection.
+     * @param t The initial collection, defaults to an empty one.
+     */
+    inline explicit CollectionProperty(const ValueType& t = ValueType{})
+        : detail::CollectionPropertyBase<ValueType, std::size_t, T>(t)
+    {
+    }
+
+    /**
+     * @brief Appends an element.
+     */
+    inline void push_back(const T& t)
+    {
+        insert(this->mutable_get().size(), t);
+    }
+
+    /**
+     * @brief Inserts an element before index.
+     */
+    inline void insert(std::size_t index, const T& t)
+    {
+        auto& vector = this->mutable_get();
+        vector.insert(vector.begin() + index, t);
+
+        this->notify(CollectionOperation::insert, index, t);
+    }
+
+    /**
+     * @brief Erases the element at index.
+     */
+    inline void erase(std::size_t index)
+    {
+        auto& vector = this->mutable_get();
+
+        T erased = std::move(vector[index]);
+        vector.erase(vector.begin() + index);
+
+        this->notify(CollectionOperation::erase, index, erased);
+    }
+
+    /**
+     * @brief Replaces the element at index, unless it equals t already.
+     * @return true iff the collection has been changed.
+     */
+    inline bool replace(std::size_t index, const T& t)
+    {
+        auto& vector = this->mutable_get();
+        if (vector[index] == t)
+            return false;
+
+        vector[index] = t;
+        this->notify(CollectionOperation::replace, index, t);
+        return true;
+    }
+};
+
+/**
+ * @brief A collection property for std::map, elements are identified by their key.
+ */
+template<typename Key, typename Value, typename Compare, typename Allocator>
+class CollectionProperty<std::map<Key, Value, Compare, Allocator>>
+        : public detail::MapCollectionProperty<std::map<Key, Value, Compare, Allocator>>
+{
+  public:
+    typedef std::map<Key, Value, Compare, Allocator> ValueType;
+
+    /**
+     * @brief CollectionProperty creates a new instance and initializes the contained collection.
+     * @param t The initial collection, defaults to an empty one.
+     */
+    inline explicit CollectionProperty(const ValueType& t = ValueType{})
+        : detail::MapCollectionProperty<ValueType>(t)
+    {
+    }
+};
+
+/**
+ * @brief A collection property for std::unordered_map, elements are identified by their key.
+ */
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+class CollectionProperty<std::unordered_map<Key, Value, Hash, KeyEqual, Allocator>>
+        : public detail::MapCollectionProperty<std::unordered_map<Key, Value, Hash, KeyEqual, Allocator>>
+{
+  public:
+    typedef std::unordered_map<Key, Value, Hash, KeyEqual, Allocator> ValueType;
+
+    /**
+     * @brief CollectionProperty creates a new instance and initializes the contained collection.
+     * @param t The initial collection, defaults to an empty one.
+     */
+    inline explicit CollectionProperty(const ValueType& t = ValueType{})
+        : detail::MapCollectionProperty<ValueType>(t)
+    {
+    }
+};
+}
+
+#endif // CORE_COLLECTION_PROPERTY_H_
@@ -0,0 +1,198 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_COMPUTED_PROPERTY_H_
+#define CORE_COMPUTED_PROPERTY_H_
+
+#include <core/connection_group.h>
+#include <core/property.h>
+
+#include <functional>
+
+namespace core
+{
+/**
+ * @brief A read-only property whose value is derived from other properties.
+ *
+ * A computed property subscribes to the changed signals of its dependencies and marks
+ * itself dirty whenever one of them changes. The value is only recomputed on the next
+ * read access, and that access emits the changed signal if and only if the recomputed
+ * value differs from the previous one. Computed properties can depend on other computed
+ * properties, invalidation propagates through the chain without recomputing anything.
+ *
+ * A note on thread-safety: Just like Property, this class does not give any thread-safety guarantees.
+ *
+ * @tparam T The type of the computed value.
+ */
+template<typename T>
+class ComputedProperty
+{
+  public:
+    /**
+     * @brief ValueType refers to the type of the computed value.
+     */
+    typedef T ValueType;
+
+    /**
+     * @brief Computation refers to the function type that derives the value.
+     */
+    typedef std::function<ValueType()> Computation;
+
+    /**
+     * @brief ComputedProperty creates a new instance and subscribes to the given dependencies.
+     * @param computation The function that derives the value, invoked lazily.
+     * @param dependencies The properties the computation reads from.
+     */
+    template<typename... Dependencies>
+    inline explicit ComputedProperty(const Computation& computation, const Dependencies&... dependencies)
+        : computation{computation},
+          value{},
+          dirty{true},
+          computed{false}
+    {
+        depend_on(dependencies...);
+    }
+
+    ComputedProperty(const ComputedProperty&) = delete;
+    ComputedProperty& operator=(const ComputedProperty&) = delete;
+
+    /**
+     * @brief Explicit casting operator to the computed value type.
+     * @return A non-mutable reference to the computed value.
+     */
+    inline operator const T&() const
+    {
+        return get();
+    }
+
+    /**
+     * @brief Provides access to a pointer to the computed value.
+     */
+    inline const T* operator->() const
+    {
+        return &get();
+    }
+
+    /**
+     * @brief Access the computed value, recomputing it if a dependency changed since the last access.
+     * @return A non-mutable reference to the computed value.
+     */
+    inline const T& get() const
+    {
+        if (!dirty)
+            return value;
+
+        // Stays dirty if the computation throws, such that the next access retries it.
+        T new_value = computation();
+        dirty = false;
+
+        if (!computed)
+        {
+            computed = true;
+            value = std::move(new_value);
+        } else if (value != new_value)
+        {
+            value = std::move(new_value);
+            signal_changed(value);
+        }
+
+        return value;
+    }
+
+    /**
+     * @brief Checks if the value has to be recomputed on the next access.
+     */
+    inline bool is_dirty() const
+    {
+        return dirty;
+    }
+
+    /**
+     * @brief Marks the value as outdated, it is recomputed on the next access.
+     */
+    inline void invalidate()
+    {
+        if (dirty)
+            return;
+
+        dirty = true;
+        signal_invalidated();
+    }
+
+    /**
+     * @brief Emitted when an access finds the recomputed value differing from the previous one.
+     *
+     * The signal is pull-driven: changing a dependency does not emit it, only the next read
+     * access that recomputes the value does, on the reading thread. Nothing is emitted for
+     * a value that is never read again, nor for the first computation. Observers that need
+     * to be pushed every change connect to invalidated() and read the value from there.
+     */
+    inline const Signal<T>& changed() const
+    {
+        return signal_changed;
+    }
+
+    /**
+     * @brief Emitted when the value becomes outdated, before it is recomputed.
+     */
+    inline const Signal<void>& invalidated() const
+    {
+        return signal_invalidated;
+    }
+
+  private:
+    // Adapts arbitrary change signals to invalidating this instance.
+    struct Invalidator
+    {
+        template<typename... Args>
+        inline void operator()(const Args&...) const
+        {
+            self->invalidate();
+        }
+
+        ComputedProperty* self;
+    };
+
+    inline void depend_on()
+    {
+    }
+
+    template<typename U, typename EqualityPolicy, typename... Dependencies>
+    inline void depend_on(const Property<U, EqualityPolicy>& dependency, const Dependencies&... dependencies)
+    {
+        connections.add(dependency.changed().connect(Invalidator{this}));
+        depend_on(dependencies...);
+    }
+
+    template<typename U, typename... Dependencies>
+    inline void depend_on(const ComputedProperty<U>& dependency, const Dependencies&... dependencies)
+    {
+        connections.add(dependency.invalidated().connect(Invalidator{this}));
+        depend_on(dependencies...);
+    }
+
+    Computation computation;
+    mutable T value;
+    mutable bool dirty;
+    mutable bool computed;
+    mutable Signal<T> signal_changed;
+    Signal<void> signal_invalidated;
+    ConnectionGroup connections;
+};
+}
+
+#endif // CORE_COMPUTED_PROPERTY_H_
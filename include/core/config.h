@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_CONFIG_H_
+#define CORE_CONFIG_H_
+
+/**
+ * @brief Feature macros describing the language and library support of the consuming translation unit.
+ *
+ * All headers of this library work with C++11. Compiling with a newer standard lets them
+ * switch to faster or simpler implementations where available, without any configuration:
+ * the macros below are derived from the standard feature-test macros. Only the features
+ * listed below are switched, the interfaces, e.g. the virtual accessors of Property, are
+ * the same for all standards. Define any of them
+ * to 0 before including a header of this library to opt out of the respective feature.
+ *
+ * PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR: std::atomic<std::shared_ptr<T>> is available (C++20).
+ * Emissions and SharedProperty::get() load snapshots wait-free without it. With it, they are
+ * only as lock-free as the standard library: libstdc++ and libc++ briefly spin on a lock of
+ * the respective instance. See detail::AtomicSharedPtr.
+ * The setting changes the layout of signals and of SharedProperty and has to be consistent
+ * across all translation units of a program. Programs that build translation units with
+ * different standards have to define it to the same value for all of them, e.g. to 0.
+ */
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#include <memory>
+
+#ifndef PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR
+#if defined(__cpp_lib_atomic_shared_ptr) && __cpp_lib_atomic_shared_ptr >= 201711L
+#define PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR 1
+#else
+#define PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR 0
+#endif
+#endif
+
+#endif // CORE_CONFIG_H_
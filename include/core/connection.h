@@ -18,20 +18,90 @@
 #ifndef COM_UBUNTU_CONNECTION_H_
 #define COM_UBUNTU_CONNECTION_H_
 
+#include <core/detail/generation_table.h>
+
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
-#include <mutex>
+#include <vector>
 
 namespace core
 {
+class ConnectionGroup;
 class ScopedConnection;
+
+namespace detail
+{
+/**
+ * @brief The interface signals expose to the handles of their connections.
+ *
+ * A connection is identified by an index into the generation table of its signal and
+ * the generation the entry had when the slot was connected. Disconnecting retires the
+ * generation, which is a single atomic operation, and lets the signal drop the slot.
+ */
+class ConnectionTarget
+{
+public:
+    typedef std::function<void(const std::function<void()>&)> Dispatcher;
+
+    struct Handle
+    {
+        std::uint32_t index;
+        std::uint32_t generation;
+    };
+
+    virtual ~ConnectionTarget() = default;
+
+    inline bool is_connected(std::uint32_t index, std::uint32_t generation) const
+    {
+        return generations.is_current(index, generation);
+    }
+
+    inline void disconnect(std::uint32_t index, std::uint32_t generation)
+    {
+        if (generations.retire(index, generation))
+            slots_retired(&index, 1);
+    }
+
+    // Disconnects a batch of connections with at most one rewrite of the slot list.
+    inline void disconnect(const Handle* handles, std::size_t count)
+    {
+        std::vector<std::uint32_t> retired;
+        retired.reserve(count);
+
+        for (std::size_t i = 0; i < count; i++)
+            if (generations.retire(handles[i].index, handles[i].generation))
+                retired.push_back(handles[i].index);
+
+        if (!retired.empty())
+            slots_retired(retired.data(), retired.size());
+    }
+
+    // Replaces the dispatcher of the connection if it is still current.
+    virtual void install_dispatcher(std::uint32_t index,
+                                    std::uint32_t generation,
+                                    const Dispatcher& dispatcher) = 0;
+
+protected:
+    // Invoked exactly once for every connection that has been disconnected.
+    virtual void slots_retired(const std::uint32_t* indices, std::size_t count) = 0;
+
+    GenerationTable generations;
+};
+}
+
 /**
  * @brief The Connection class models a signal-slot connection.
+ *
+ * Instances are lightweight handles that refer to their signal weakly. Copies of a
+ * connection are interchangeable and outliving the signal is fine: all operations
+ * turn into no-ops once the signal has been destroyed.
  */
 class Connection
 {
 public:    
-    typedef std::function<void(const std::function<void()>&)> Dispatcher;
+    typedef detail::ConnectionTarget::Dispatcher Dispatcher;
 
     /**
      * @brief Checks if this instance corresponds to an active signal-slot connection.
@@ -39,100 +109,70 @@ public:
      */
     inline bool is_connected() const
     {
-        if (!d)
-            return false;
-
-        return (d->disconnector ? true : false);
+        auto t = target.lock();
+        return t && t->is_connected(index, generation);
     }
 
     /**
      * @brief End a signal-slot connection.
+     *
+     * The slot and its captured state are released right away, or once the emissions in
+     * progress that refer to it have finished. Disconnecting does not wait for those
+     * emissions, and usually does not allocate as signals reuse the storage of their
+     * replaced snapshots.
      */
     inline void disconnect()
     {
-        if (d)
-            d->disconnect();
+        if (auto t = target.lock())
+            t->disconnect(index, generation);
     }
 
     /**
      * @brief Installs a dispatcher for this signal-slot connection.
+     *
+     * Connections without a dispatcher invoke their slot immediately on the emitting thread,
+     * without allocating. Installing an empty dispatcher restores this behavior.
+     *
      * @param dispatcher The dispatcher to be used for signal emissions.
      */
     inline void dispatch_via(const Dispatcher& dispatcher)
     {
-        if (d && d->dispatcher_installer)
-            d->dispatcher_installer(dispatcher);
+        if (auto t = target.lock())
+            t->install_dispatcher(index, generation, dispatcher);
     }
 
 private:
     friend class ScopedConnection;
-
-    typedef std::function<void()> Disconnector;
-    typedef std::function<void(const Dispatcher&)> DispatcherInstaller;
+    friend class ConnectionGroup;
 
     template<typename ... Arguments> friend class Signal;
-
-    inline Connection(const Disconnector& disconnector,
-                      const DispatcherInstaller& installer)
-        : d(std::make_shared<Private>(disconnector, installer))
+    template<typename SlotPolicy, typename ... Arguments> friend class BasicSignal;
+    template<typename ... Arguments> friend class ShardedSignal;
+
+    inline Connection(const std::weak_ptr<detail::ConnectionTarget>& target,
+                      std::uint32_t index,
+                      std::uint32_t generation)
+        : target(target),
+          index(index),
+          generation(generation)
     {
     }
 
     inline bool operator<(const Connection& rhs) const
     {
-        return d < rhs.d;
-    }
+        if (target.owner_before(rhs.target))
+            return true;
+        if (rhs.target.owner_before(target))
+            return false;
+        if (index != rhs.index)
+            return index < rhs.index;
 
-    inline void reset()
-    {
-        if (d)
-            d->reset();
+        return generation < rhs.generation;
     }
 
-    struct Private
-    {
-        Private(const Connection::Disconnector& disconnector,
-                const Connection::DispatcherInstaller& dispatcher_installer)
-            : disconnector(disconnector),
-              dispatcher_installer(dispatcher_installer)
-        {
-        }
-
-        inline void reset()
-        {
-            std::lock_guard<std::mutex> lg(guard);
-            reset_locked();
-        }
-
-        inline void reset_locked()
-        {
-            static const Connection::Disconnector empty_disconnector{};
-            static const Connection::DispatcherInstaller empty_dispatcher_installer{};
-
-            disconnector = empty_disconnector;
-            dispatcher_installer = empty_dispatcher_installer;
-        }
-
-        inline void disconnect()
-        {
-            static const Connection::Disconnector empty_disconnector{};
-
-            std::lock_guard<std::mutex> lg(guard);
-
-            if (disconnector)
-                disconnector();
-
-            reset_locked();
-        }
-
-        std::mutex guard;
-        Connection::Disconnector disconnector;
-        Connection::DispatcherInstaller dispatcher_installer;
-    };
-
-    // The whole class is implicitly shared and we thus forward our complete
-    // shared state to a private structure that is lifetime-managed by a shared_ptr.
-    std::shared_ptr<Private> d;
+    std::weak_ptr<detail::ConnectionTarget> target;
+    std::uint32_t index;
+    std::uint32_t generation;
 };
 
 /**
@@ -0,0 +1,163 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_CONNECTION_GROUP_H_
+#define CORE_CONNECTION_GROUP_H_
+
+#include <core/connection.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+/**
+ * @brief Owns a set of signal-slot connections and ends all of them at once.
+ *
+ * Connections are stored contiguously. Disconnecting the group batches its connections
+ * per signal, such that tearing down any number of connections to the same signal
+ * rewrites the slot list of that signal at most once.
+ *
+ * The group disconnects all of its connections when it goes out of scope.
+ */
+class ConnectionGroup
+{
+public:
+    inline ConnectionGroup() = default;
+
+    inline ConnectionGroup(ConnectionGroup&& rhs) : connections(std::move(rhs.connections))
+    {
+        rhs.connections.clear();
+    }
+
+    ConnectionGroup(const ConnectionGroup&) = delete;
+
+    /**
+     * @brief Disconnects all connections of the group.
+     */
+    inline ~ConnectionGroup() noexcept(true)
+    {
+        try
+        {
+            disconnect();
+        } catch(...)
+        {
+        }
+    }
+
+    /**
+     * @brief Disconnects all connections of the group, then takes over the ones of rhs.
+     */
+    inline ConnectionGroup& operator=(ConnectionGroup&& rhs)
+    {
+        if (this == &rhs)
+            return *this;
+
+        disconnect();
+
+        connections = std::move(rhs.connections);
+        rhs.connections.clear();
+        return *this;
+    }
+
+    ConnectionGroup& operator=(const ConnectionGroup&) = delete;
+    bool operator==(const ConnectionGroup&) = delete;
+
+    /**
+     * @brief Adds an existing signal-slot connection to the group.
+     * @param connection The existing signal-slot connection.
+     */
+    inline void add(const Connection& connection)
+    {
+        connections.push_back(connection);
+    }
+
+    /**
+     * @brief Adds existing signal-slot connections to the group, e.g. the result of Signal::connect_many.
+     * @param connections The existing signal-slot connections.
+     */
+    inline void add(const std::vector<Connection>& connections)
+    {
+        this->connections.insert(this->connections.end(), connections.begin(), connections.end());
+    }
+
+    /**
+     * @brief Queries the number of connections owned by the group, connected or not.
+     */
+    inline std::size_t size() const
+    {
+        return connections.size();
+    }
+
+    /**
+     * @brief Checks if the group does not own any connections.
+     */
+    inline bool empty() const
+    {
+        return connections.empty();
+    }
+
+    /**
+     * @brief Ends all connections of the group and empties it.
+     */
+    inline void disconnect()
+    {
+        if (connections.empty())
+            return;
+
+        // Connections order by their signal first, grouping them into runs.
+        std::sort(connections.begin(),
+                  connections.end(),
+                  [](const Connection& lhs, const Connection& rhs) { return lhs < rhs; });
+
+        std::vector<detail::ConnectionTarget::Handle> handles;
+        handles.reserve(connections.size());
+
+        auto run = connections.begin();
+        while (run != connections.end())
+        {
+            auto run_end = run;
+            handles.clear();
+
+            while (run_end != connections.end() && !owner_differs(*run, *run_end))
+            {
+                handles.push_back(detail::ConnectionTarget::Handle{run_end->index, run_end->generation});
+                ++run_end;
+            }
+
+            if (auto target = run->target.lock())
+                target->disconnect(handles.data(), handles.size());
+
+            run = run_end;
+        }
+
+        connections.clear();
+    }
+
+private:
+    static inline bool owner_differs(const Connection& lhs, const Connection& rhs)
+    {
+        return lhs.target.owner_before(rhs.target) || rhs.target.owner_before(lhs.target);
+    }
+
+    std::vector<Connection> connections;
+};
+}
+
+#endif // CORE_CONNECTION_GROUP_H_
@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_DETAIL_ATOMIC_SHARED_PTR_H_
+#define CORE_DETAIL_ATOMIC_SHARED_PTR_H_
+
+#include <core/config.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace core
+{
+namespace detail
+{
+/**
+ * @brief A shared_ptr that is loaded and stored atomically.
+ *
+ * Uses std::atomic<std::shared_ptr<T>> where available (C++20), which is lock-free
+ * depending on the standard library: libstdc++ and libc++ guard each instance with a
+ * spin lock of its own, held for the duration of a reference count update.
+ *
+ * Otherwise, keeps two shared_ptr slots and counts the readers of both, see Readers.
+ * Loading never blocks and takes a fixed number of atomic operations (wait-free),
+ * while storing waits for the loads that might still copy the replaced slot, which
+ * takes no longer than copying a shared_ptr. This avoids the atomic access functions
+ * for shared_ptr, which libstdc++ and libc++ implement on top of a process-wide pool
+ * of mutexes shared by all instances.
+ *
+ * Stores have to be serialized by the caller. The layout differs between both variants,
+ * see PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR in core/config.h.
+ */
+template<typename T>
+class AtomicSharedPtr
+{
+public:
+#if PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR
+    inline explicit AtomicSharedPtr(std::shared_ptr<T> ptr) : ptr(std::move(ptr))
+    {
+    }
+#else
+    inline explicit AtomicSharedPtr(std::shared_ptr<T> ptr) : current(0), version(0)
+    {
+        slots[0] = std::move(ptr);
+        readers[0].count.store(0, std::memory_order_relaxed);
+        readers[1].count.store(0, std::memory_order_relaxed);
+    }
+#endif
+
+    AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+    inline std::shared_ptr<T> load() const
+    {
+#if PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR
+        return ptr.load(std::memory_order_acquire);
+#else
+        auto& registered = readers[version.load()].count;
+        registered.fetch_add(1);
+
+        std::shared_ptr<T> result = slots[current.load()];
+
+        registered.fetch_sub(1, std::memory_order_release);
+        return result;
+#endif
+    }
+
+    inline void store(std::shared_ptr<T> desired)
+    {
+        exchange(std::move(desired));
+    }
+
+    inline std::shared_ptr<T> exchange(std::shared_ptr<T> desired)
+    {
+#if PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR
+        return ptr.exchange(std::move(desired), std::memory_order_acq_rel);
+#else
+        unsigned int next = current.load(std::memory_order_relaxed) ^ 1;
+
+        // No load copies slots[next] anymore, see below.
+        slots[next] = std::move(desired);
+        current.store(next);
+
+        // Loads that have seen the replaced slot registered with either reader count
+        // before doing so. Toggling the version lets the one to be waited for drain,
+        // as new loads register with the other one and only see the new slot.
+        unsigned int previous_version = version.load(std::memory_order_relaxed);
+        wait_for(readers[previous_version ^ 1]);
+        version.store(previous_version ^ 1);
+        wait_for(readers[previous_version]);
+
+        return std::move(slots[next ^ 1]);
+#endif
+    }
+
+private:
+#if PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR
+    std::atomic<std::shared_ptr<T>> ptr;
+#else
+    // The number of loads in progress that registered with a version, padded to a cache line.
+    struct Readers
+    {
+        std::atomic<std::size_t> count;
+        char padding[64 - sizeof(std::atomic<std::size_t>)];
+    };
+
+    static inline void wait_for(const Readers& r)
+    {
+        while (r.count.load() != 0)
+            std::this_thread::yield();
+    }
+
+    std::shared_ptr<T> slots[2];
+    std::atomic<unsigned int> current;
+    std::atomic<unsigned int> version;
+    mutable Readers readers[2];
+#endif
+};
+}
+}
+
+#endif // CORE_DETAIL_ATOMIC_SHARED_PTR_H_
@@ -0,0 +1,160 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_DETAIL_GENERATION_TABLE_H_
+#define CORE_DETAIL_GENERATION_TABLE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace core
+{
+namespace detail
+{
+/**
+ * @brief A table of generation counters, addressed by index.
+ *
+ * A slot handle (index, generation) is current as long as the counter stored at index
+ * equals generation. Retiring a handle increments the counter, invalidating all copies
+ * of the handle at once. The table grows in segments of doubling size that never move,
+ * such that entries can be read without synchronization while the table grows.
+ *
+ * Acquiring and releasing indices has to be serialized by the caller, querying and
+ * retiring handles is lock-free.
+ */
+class GenerationTable
+{
+public:
+    typedef std::atomic<std::uint32_t> Entry;
+
+    inline GenerationTable() : next_index(0)
+    {
+        for (auto& segment : segments)
+            segment.store(nullptr, std::memory_order_relaxed);
+    }
+
+    inline ~GenerationTable()
+    {
+        for (auto& segment : segments)
+            delete[] segment.load(std::memory_order_relaxed);
+    }
+
+    GenerationTable(const GenerationTable&) = delete;
+    GenerationTable& operator=(const GenerationTable&) = delete;
+
+    /**
+     * @brief Hands out an unused index, reusing released ones first.
+     */
+    inline std::uint32_t acquire()
+    {
+        if (!free_indices.empty())
+        {
+            std::uint32_t index = free_indices.back();
+            free_indices.pop_back();
+            return index;
+        }
+
+        std::size_t segment, offset;
+        locate(next_index, segment, offset);
+
+        if (offset == 0)
+        {
+            // Every index handed out can be released again, make sure that never allocates.
+            free_indices.reserve(base_of(segment + 1));
+
+            Entry* entries = new Entry[first_segment_size << segment];
+            for (std::size_t i = 0; i < (first_segment_size << segment); i++)
+                entries[i].store(0, std::memory_order_relaxed);
+
+            segments[segment].store(entries, std::memory_order_release);
+        }
+
+        return next_index++;
+    }
+
+    /**
+     * @brief Returns a retired index to the pool of unused indices. Never allocates.
+     */
+    inline void release(std::uint32_t index)
+    {
+        free_indices.push_back(index);
+    }
+
+    /**
+     * @brief Accesses the counter for an acquired index. Entries never move.
+     */
+    inline Entry& entry(std::uint32_t index) const
+    {
+        std::size_t segment, offset;
+        locate(index, segment, offset);
+
+        return segments[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    /**
+     * @brief Checks if the handle (index, generation) is still current.
+     */
+    inline bool is_current(std::uint32_t index, std::uint32_t generation) const
+    {
+        return entry(index).load(std::memory_order_acquire) == generation;
+    }
+
+    /**
+     * @brief Retires the handle (index, generation).
+     * @return true iff the handle was current and has been retired by this call.
+     */
+    inline bool retire(std::uint32_t index, std::uint32_t generation)
+    {
+        return entry(index).compare_exchange_strong(generation, generation + 1, std::memory_order_acq_rel);
+    }
+
+private:
+    static constexpr std::size_t first_segment_size = 16;
+    static constexpr std::size_t max_segments = 28;
+
+    // The first index stored in segment.
+    static inline std::size_t base_of(std::size_t segment)
+    {
+        return first_segment_size * ((std::size_t(1) << segment) - 1);
+    }
+
+    static inline void locate(std::uint32_t index, std::size_t& segment, std::size_t& offset)
+    {
+        std::size_t base = 0;
+        std::size_t size = first_segment_size;
+
+        segment = 0;
+        while (index >= base + size)
+        {
+            base += size;
+            size <<= 1;
+            segment++;
+        }
+
+        offset = index - base;
+    }
+
+    std::atomic<Entry*> segments[max_segments];
+    std::uint32_t next_index;
+    std::vector<std::uint32_t> free_indices;
+};
+}
+}
+
+#endif // CORE_DETAIL_GENERATION_TABLE_H_
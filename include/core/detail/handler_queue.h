@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_DETAIL_HANDLER_QUEUE_H_
+#define CORE_DETAIL_HANDLER_QUEUE_H_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace core
+{
+namespace detail
+{
+/**
+ * @brief Type-erased operations on a handler of unknown type, referred to by pointer.
+ */
+struct HandlerOperations
+{
+    std::size_t size;
+    std::size_t alignment;
+    // Move-constructs the handler at from into the uninitialized storage at to.
+    void (*move_to)(void* from, void* to);
+    // Moves the handler at from into a std::function, for storage that is too small.
+    std::function<void()> (*wrap)(void* from);
+    void (*invoke)(void* handler);
+    void (*destroy)(void* handler);
+};
+
+template<typename Handler>
+struct HandlerOperationsFor
+{
+    static void move_to(void* from, void* to)
+    {
+        new (to) Handler(std::move(*static_cast<Handler*>(from)));
+    }
+
+    static std::function<void()> wrap(void* from)
+    {
+        return std::function<void()>(std::move(*static_cast<Handler*>(from)));
+    }
+
+    static void invoke(void* handler)
+    {
+        (*static_cast<Handler*>(handler))();
+    }
+
+    static void destroy(void* handler)
+    {
+        static_cast<Handler*>(handler)->~Handler();
+    }
+
+    static const HandlerOperations table;
+};
+
+template<typename Handler>
+const HandlerOperations HandlerOperationsFor<Handler>::table =
+{
+    sizeof(Handler),
+    alignof(Handler),
+    &HandlerOperationsFor<Handler>::move_to,
+    &HandlerOperationsFor<Handler>::wrap,
+    &HandlerOperationsFor<Handler>::invoke,
+    &HandlerOperationsFor<Handler>::destroy
+};
+
+/**
+ * @brief Implemented by queueing dispatchers that store handlers in their own memory.
+ *
+ * Signals recognize the adaptor returned by adaptor() and move queued invocations
+ * straight into the queue, instead of wrapping them in a std::function first.
+ */
+class HandlerQueue
+{
+public:
+    /**
+     * @brief The Connection::Dispatcher adaptor of a handler queue.
+     */
+    struct Adaptor
+    {
+        inline void operator()(const std::function<void()>& handler) const
+        {
+            queue->enqueue(handler);
+        }
+
+        HandlerQueue* queue;
+    };
+
+    // Moves the handler into the queue, the caller still destroys the moved-from handler.
+    virtual void enqueue(void* handler, const HandlerOperations& operations) = 0;
+
+    template<typename Handler>
+    inline void enqueue(Handler&& handler)
+    {
+        typename std::decay<Handler>::type queued(std::forward<Handler>(handler));
+        enqueue(&queued, HandlerOperationsFor<typename std::decay<Handler>::type>::table);
+    }
+
+protected:
+    ~HandlerQueue() = default;
+
+    inline Adaptor adaptor()
+    {
+        return Adaptor{this};
+    }
+};
+}
+}
+
+#endif // CORE_DETAIL_HANDLER_QUEUE_H_
@@ -0,0 +1,47 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_DETAIL_INDEX_SEQUENCE_H_
+#define CORE_DETAIL_INDEX_SEQUENCE_H_
+
+#include <cstddef>
+
+namespace core
+{
+namespace detail
+{
+// A compile-time sequence of indices, used for unpacking tuples (std::index_sequence is C++14).
+template<std::size_t... Indices>
+struct IndexSequence
+{
+};
+
+// Yields IndexSequence<0, ..., N-1> as Type.
+template<std::size_t N, std::size_t... Indices>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, Indices...>
+{
+};
+
+template<std::size_t... Indices>
+struct MakeIndexSequence<0, Indices...>
+{
+    typedef IndexSequence<Indices...> Type;
+};
+}
+}
+
+#endif // CORE_DETAIL_INDEX_SEQUENCE_H_
@@ -0,0 +1,381 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_DETAIL_SIGNAL_STATE_H_
+#define CORE_DETAIL_SIGNAL_STATE_H_
+
+#include <core/connection.h>
+#include <core/detail/atomic_shared_ptr.h>
+#include <core/detail/generation_table.h>
+#include <core/detail/small_vector.h>
+#include <core/instrumentation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace core
+{
+namespace detail
+{
+/**
+ * @brief Identifies a slot within a snapshot, and tells whether it is still connected.
+ */
+struct SlotHandle
+{
+    inline bool is_alive() const
+    {
+        return state->load(std::memory_order_acquire) == generation;
+    }
+
+    const GenerationTable::Entry* state;
+    std::uint32_t index;
+    std::uint32_t generation;
+};
+
+/**
+ * @brief A node of the intrusive list of waiters for the next emission of a signal.
+ *
+ * Nodes are owned by whoever waits, typically a suspended coroutine frame, and are
+ * linked into the signal without allocating.
+ */
+struct WaiterNode
+{
+    WaiterNode* next = nullptr;
+    bool registered = false;
+};
+
+/**
+ * @brief The state shared between a signal and the handles of its connections.
+ *
+ * Slots live in immutable snapshots that are replaced as a whole by writers serialized on
+ * guard. Disconnecting a slot retires its handle and compacts the snapshot right away, or
+ * once the outermost emission in progress has finished, emissions skip retired slots in
+ * the meantime. The storage of replaced snapshots no emission refers to anymore is reused
+ * for the next one, such that disconnecting does not allocate in the steady state. Snapshots are ordered by descending priority, slots of
+ * equal priority in the order they have been added in.
+ *
+ * @tparam SlotWrapper The slot type stored in snapshots, providing the members
+ * dispatcher, handle, probe and priority.
+ * @tparam Allocator The stateless allocator snapshots are allocated with.
+ */
+template<typename SlotWrapper, typename Allocator = std::allocator<SlotWrapper>>
+class SignalState : public ConnectionTarget
+{
+public:
+    // Most signals only have a handful of observers, those are kept
+    // inline in the snapshot and thus contiguous in memory.
+    typedef SmallVector<SlotWrapper, 4, Allocator> SlotList;
+
+    inline explicit SignalState(const std::string& name)
+        : probe(name),
+          slot_list(std::allocate_shared<SlotList>(Allocator{})),
+          slots_present(false),
+          emissions(0),
+          compaction_pending(false),
+          waiters(nullptr),
+          has_waiters(false)
+    {
+    }
+
+    // Reports to the instrumentation statistics of the state probe belongs to, see SignalProbe.
+    inline SignalState(const SignalProbe& parent, std::size_t ordinal)
+        : probe(parent, ordinal),
+          slot_list(std::allocate_shared<SlotList>(Allocator{})),
+          slots_present(false),
+          emissions(0),
+          compaction_pending(false),
+          waiters(nullptr),
+          has_waiters(false)
+    {
+    }
+
+    // Returns the current snapshot of the slot list. Never blocks on guard.
+    inline std::shared_ptr<const SlotList> snapshot() const
+    {
+        return slot_list.load();
+    }
+
+    // Checks if the current snapshot holds any slot, connected or retired but not yet
+    // compacted. Lets emissions skip all other bookkeeping for signals without slots.
+    inline bool has_slots() const
+    {
+        return slots_present.load(std::memory_order_acquire);
+    }
+
+    // Moves the slots in [first, last) into a single new snapshot, behind all slots of
+    // higher or equal priority. The handles assigned to them remain readable from the
+    // moved-from wrappers.
+    inline void add(SlotWrapper* first, SlotWrapper* last)
+    {
+        std::shared_ptr<const SlotList> previous;
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            auto guard_timer = probe.time_guard(); (void) guard_timer;
+
+            auto slots = fresh_list(snapshot()->size() + (last - first));
+            copy_alive_slots(*slots);
+
+            for (SlotWrapper* wrapper = first; wrapper != last; ++wrapper)
+            {
+                std::uint32_t index = generations.acquire();
+                const auto& entry = generations.entry(index);
+
+                wrapper->handle = SlotHandle{&entry, index, entry.load(std::memory_order_relaxed)};
+                wrapper->probe = probe.slot_connected(index);
+
+                slots->push_back(std::move(*wrapper));
+
+                auto position = std::upper_bound(
+                            slots->begin(),
+                            slots->end() - 1,
+                            *(slots->end() - 1),
+                            [](const SlotWrapper& lhs, const SlotWrapper& rhs) { return lhs.priority > rhs.priority; });
+                std::rotate(position, slots->end() - 1, slots->end());
+            }
+
+            previous = publish(std::move(slots));
+        }
+        recycle(std::move(previous));
+    }
+
+    inline void install_dispatcher(std::uint32_t index,
+                                   std::uint32_t generation,
+                                   const Connection::Dispatcher& dispatcher) override
+    {
+        std::shared_ptr<const SlotList> previous;
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            auto guard_timer = probe.time_guard(); (void) guard_timer;
+
+            if (!generations.is_current(index, generation))
+                return;
+
+            auto slots = fresh_list(snapshot()->size());
+            copy_alive_slots(*slots);
+
+            for (auto& slot : *slots)
+                if (slot.handle.index == index)
+                    slot.dispatcher = dispatcher;
+
+            previous = publish(std::move(slots));
+        }
+        recycle(std::move(previous));
+    }
+
+    // Registers a waiter for the next emission.
+    inline void enqueue(WaiterNode* waiter)
+    {
+        std::lock_guard<std::mutex> lg(guard);
+
+        waiter->next = waiters;
+        waiter->registered = true;
+        waiters = waiter;
+        has_waiters.store(true, std::memory_order_release);
+    }
+
+    // Unregisters a waiter, if it has not been taken by an emission yet.
+    inline void remove(WaiterNode* waiter)
+    {
+        std::lock_guard<std::mutex> lg(guard);
+
+        if (!waiter->registered)
+            return;
+
+        for (WaiterNode** link = &waiters; *link; link = &(*link)->next)
+        {
+            if (*link != waiter)
+                continue;
+
+            *link = waiter->next;
+            break;
+        }
+
+        waiter->registered = false;
+        has_waiters.store(waiters != nullptr, std::memory_order_release);
+    }
+
+    // Takes all registered waiters, in the order they have been registered in.
+    // Returns nullptr without taking the guard if there are none.
+    inline WaiterNode* take_waiters()
+    {
+        if (!has_waiters.load(std::memory_order_acquire))
+            return nullptr;
+
+        std::lock_guard<std::mutex> lg(guard);
+
+        WaiterNode* taken = nullptr;
+        while (waiters)
+        {
+            WaiterNode* waiter = waiters;
+            waiters = waiter->next;
+
+            waiter->registered = false;
+            waiter->next = taken;
+            taken = waiter;
+        }
+
+        has_waiters.store(false, std::memory_order_release);
+        return taken;
+    }
+
+    detail::SignalProbe probe;
+
+    /**
+     * @brief Marks an emission in progress for its lifetime.
+     *
+     * Slots disconnected while any emission is in progress are only tombstoned, the
+     * slot list is compacted in one batch once the outermost emission has finished.
+     * Emissions that outlive their scope, e.g. queued to a dispatcher, keep their
+     * snapshot and thus the retired slots in it alive until they are done.
+     */
+    class EmissionScope
+    {
+    public:
+        inline explicit EmissionScope(SignalState& state) : state(state)
+        {
+            state.emissions.fetch_add(1);
+        }
+
+        inline ~EmissionScope()
+        {
+            if (state.emissions.fetch_sub(1) == 1 && state.compaction_pending.load())
+                state.compact();
+        }
+
+        EmissionScope(const EmissionScope&) = delete;
+        EmissionScope& operator=(const EmissionScope&) = delete;
+
+    private:
+        SignalState& state;
+    };
+
+protected:
+    inline void slots_retired(const std::uint32_t* indices, std::size_t count) override
+    {
+        for (std::size_t i = 0; i < count; i++)
+            probe.slot_disconnected(indices[i]);
+
+        // Retired slots are dropped right away, releasing their state and their indices.
+        // Any emission in progress compacts once it is done, see EmissionScope.
+        compaction_pending.store(true);
+        if (emissions.load() == 0)
+            compact();
+    }
+
+private:
+    // Drops all retired slots from the slot list.
+    inline void compact()
+    {
+        if (!compaction_pending.exchange(false))
+            return;
+
+        std::shared_ptr<const SlotList> previous;
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            auto guard_timer = probe.time_guard(); (void) guard_timer;
+
+            auto current = snapshot();
+            auto alive = static_cast<std::size_t>(std::count_if(
+                        current->begin(),
+                        current->end(),
+                        [](const SlotWrapper& slot) { return slot.handle.is_alive(); }));
+            if (alive == current->size())
+                return;
+
+            auto slots = fresh_list(alive);
+            copy_alive_slots(*slots);
+            previous = publish(std::move(slots));
+        }
+        recycle(std::move(previous));
+    }
+
+    // Publishes a new snapshot of the slot list and returns the replaced one, guard has
+    // to be held by the caller.
+    inline std::shared_ptr<const SlotList> publish(std::shared_ptr<const SlotList> slots)
+    {
+        bool present = !slots->empty();
+        auto previous = slot_list.exchange(std::move(slots));
+        slots_present.store(present, std::memory_order_release);
+        return previous;
+    }
+
+    // Hands out an empty slot list for a new snapshot that fits capacity slots, reusing
+    // the spare one if available. Guard has to be held by the caller.
+    inline std::shared_ptr<SlotList> fresh_list(std::size_t capacity)
+    {
+        auto slots = spare ? std::move(spare) : std::allocate_shared<SlotList>(Allocator{});
+        slots->reserve(capacity);
+        return slots;
+    }
+
+    // Keeps a replaced snapshot as the spare slot list if no emission refers to it anymore.
+    // Destroying its slots might disconnect or connect slots, it is thus cleared without
+    // holding guard. Slots are only released once the last emission referring to them
+    // has finished otherwise.
+    inline void recycle(std::shared_ptr<const SlotList> previous)
+    {
+        if (!previous || previous.use_count() != 1)
+            return;
+
+        // Pairs with the release of the references held by finished emissions.
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        auto slots = std::const_pointer_cast<SlotList>(std::move(previous));
+        slots->clear();
+
+        std::lock_guard<std::mutex> lg(guard);
+        if (!spare || spare->capacity() < slots->capacity())
+            spare = std::move(slots);
+    }
+
+    // Copies all connected slots of the current snapshot and recycles the indices of
+    // the retired ones, guard has to be held by the caller.
+    inline void copy_alive_slots(SlotList& slots)
+    {
+        auto current = snapshot();
+        for (const auto& slot : *current)
+        {
+            if (slot.handle.is_alive())
+            {
+                slots.push_back(slot);
+                continue;
+            }
+
+            generations.release(slot.handle.index);
+        }
+    }
+
+    // Serializes all modifications of the slot list, never taken for emissions.
+    std::mutex guard;
+    AtomicSharedPtr<const SlotList> slot_list;
+    // Storage of a replaced snapshot, reused for the next one.
+    std::shared_ptr<SlotList> spare;
+    std::atomic<bool> slots_present;
+    std::atomic<std::size_t> emissions;
+    std::atomic<bool> compaction_pending;
+    WaiterNode* waiters;
+    std::atomic<bool> has_waiters;
+};
+}
+}
+
+#endif // CORE_DETAIL_SIGNAL_STATE_H_
@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_DETAIL_SMALL_VECTOR_H_
+#define CORE_DETAIL_SMALL_VECTOR_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace core
+{
+namespace detail
+{
+/**
+ * @brief Contiguous sequence container that keeps its first N elements inline.
+ *
+ * Elements are only moved to the heap once the inline capacity is exceeded.
+ * Iterators and references are invalidated by any operation that grows the container.
+ *
+ * @tparam T The element type.
+ * @tparam N The number of elements stored inline.
+ * @tparam Allocator Provides the heap storage, has to be stateless.
+ */
+template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+class SmallVector
+{
+    static_assert(N > 0, "SmallVector requires an inline capacity of at least one element.");
+
+public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    inline SmallVector() noexcept(true)
+        : elements(inline_elements()),
+          element_count(0),
+          element_capacity(N)
+    {
+    }
+
+    inline SmallVector(const SmallVector& rhs) : SmallVector()
+    {
+        reserve(rhs.size());
+        for (const auto& element : rhs)
+            push_back(element);
+    }
+
+    inline SmallVector(SmallVector&& rhs) : SmallVector()
+    {
+        swap(rhs);
+    }
+
+    inline ~SmallVector()
+    {
+        clear();
+        release();
+    }
+
+    inline SmallVector& operator=(SmallVector rhs)
+    {
+        swap(rhs);
+        return *this;
+    }
+
+    inline iterator begin() { return elements; }
+    inline iterator end() { return elements + element_count; }
+    inline const_iterator begin() const { return elements; }
+    inline const_iterator end() const { return elements + element_count; }
+
+    inline T& operator[](std::size_t i) { return elements[i]; }
+    inline const T& operator[](std::size_t i) const { return elements[i]; }
+
+    inline std::size_t size() const { return element_count; }
+    inline std::size_t capacity() const { return element_capacity; }
+    inline bool empty() const { return element_count == 0; }
+
+    /**
+     * @brief Ensures that at least new_capacity elements fit without reallocating.
+     */
+    inline void reserve(std::size_t new_capacity)
+    {
+        if (new_capacity <= element_capacity)
+            return;
+
+        HeapAllocator allocator;
+        T* new_elements = HeapAllocatorTraits::allocate(allocator, new_capacity);
+
+        for (std::size_t i = 0; i < element_count; i++)
+        {
+            new (new_elements + i) T(std::move(elements[i]));
+            elements[i].~T();
+        }
+
+        release();
+        elements = new_elements;
+        element_capacity = new_capacity;
+    }
+
+    template<typename... Args>
+    inline void emplace_back(Args&&... args)
+    {
+        if (element_count == element_capacity)
+            reserve(2 * element_capacity);
+
+        new (elements + element_count) T(std::forward<Args>(args)...);
+        element_count++;
+    }
+
+    inline void push_back(const T& t)
+    {
+        emplace_back(t);
+    }
+
+    inline void push_back(T&& t)
+    {
+        emplace_back(std::move(t));
+    }
+
+    inline void clear()
+    {
+        for (std::size_t i = 0; i < element_count; i++)
+            elements[i].~T();
+
+        element_count = 0;
+    }
+
+    inline void swap(SmallVector& rhs)
+    {
+        // Heap storage can be exchanged, inline storage has to be moved element by element.
+        if (!is_inline() && !rhs.is_inline())
+        {
+            std::swap(elements, rhs.elements);
+            std::swap(element_count, rhs.element_count);
+            std::swap(element_capacity, rhs.element_capacity);
+            return;
+        }
+
+        SmallVector tmp;
+        tmp.steal(*this);
+        steal(rhs);
+        rhs.steal(tmp);
+    }
+
+private:
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<T> HeapAllocator;
+    typedef std::allocator_traits<HeapAllocator> HeapAllocatorTraits;
+
+    inline T* inline_elements()
+    {
+        return reinterpret_cast<T*>(storage);
+    }
+
+    inline bool is_inline() const
+    {
+        return elements == reinterpret_cast<const T*>(storage);
+    }
+
+    inline void release()
+    {
+        if (!is_inline())
+        {
+            HeapAllocator allocator;
+            HeapAllocatorTraits::deallocate(allocator, elements, element_capacity);
+        }
+
+        elements = inline_elements();
+        element_capacity = N;
+    }
+
+    // Moves all elements of rhs into this empty instance, leaving rhs empty.
+    inline void steal(SmallVector& rhs)
+    {
+        if (!rhs.is_inline())
+        {
+            elements = rhs.elements;
+            element_count = rhs.element_count;
+            element_capacity = rhs.element_capacity;
+
+            rhs.elements = rhs.inline_elements();
+            rhs.element_count = 0;
+            rhs.element_capacity = N;
+            return;
+        }
+
+        for (auto& element : rhs)
+            emplace_back(std::move(element));
+
+        rhs.clear();
+    }
+
+    Storage storage[N];
+    T* elements;
+    std::size_t element_count;
+    std::size_t element_capacity;
+};
+}
+}
+
+#endif // CORE_DETAIL_SMALL_VECTOR_H_
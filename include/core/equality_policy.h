@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_EQUALITY_POLICY_H_
+#define CORE_EQUALITY_POLICY_H_
+
+#include <functional>
+
+namespace core
+{
+/**
+ * @brief Decides whether a new value equals the contained one by means of operator==.
+ *
+ * This is the default policy of core::Property. An equality policy is a type with a static
+ * member function template equal(const T& current, const T& candidate), returning true iff
+ * assigning candidate would not change the property, in which case neither the value is
+ * stored nor observers are notified.
+ */
+struct ByValue
+{
+    template<typename T>
+    static inline bool equal(const T& current, const T& candidate)
+    {
+        return current == candidate;
+    }
+};
+
+/**
+ * @brief Considers every new value to be different, set() always stores and notifies.
+ *
+ * Suits values whose comparison costs about as much as reacting to a spurious notification,
+ * or types without operator== at all.
+ */
+struct AlwaysNotify
+{
+    template<typename T>
+    static inline bool equal(const T&, const T&)
+    {
+        return false;
+    }
+};
+
+/**
+ * @brief Compares the version stamps of two values instead of their contents.
+ *
+ * The value type has to provide a member function version() returning a stamp that is
+ * changed, e.g. incremented, with every modification of the value. Two values carrying the
+ * same stamp are considered equal, whatever their contents.
+ */
+struct ByVersion
+{
+    template<typename T>
+    static inline bool equal(const T& current, const T& candidate)
+    {
+        return current.version() == candidate.version();
+    }
+};
+
+/**
+ * @brief Compares the hashes of two values instead of their contents.
+ *
+ * Pays off if Hash is considerably cheaper than operator==, e.g. because the value type
+ * caches its hash. Note that a hash collision makes set() silently drop a changed value.
+ *
+ * @tparam Hash The hash function, std::hash of the value type by default.
+ */
+template<typename Hash = void>
+struct ByHash
+{
+    template<typename T>
+    static inline bool equal(const T& current, const T& candidate)
+    {
+        Hash hash;
+        return hash(current) == hash(candidate);
+    }
+};
+
+template<>
+struct ByHash<void>
+{
+    template<typename T>
+    static inline bool equal(const T& current, const T& candidate)
+    {
+        return ByHash<std::hash<T>>::equal(current, candidate);
+    }
+};
+}
+
+#endif // CORE_EQUALITY_POLICY_H_
@@ -0,0 +1,434 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_EVENT_LOOP_DISPATCHER_H_
+#define CORE_EVENT_LOOP_DISPATCHER_H_
+
+#include <core/connection.h>
+#include <core/detail/handler_queue.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace core
+{
+/**
+ * @brief A queueing dispatcher that executes handlers on the thread running its event loop.
+ *
+ * Handlers are stored in a bounded ring of preallocated cells. Any number of threads can
+ * dispatch handlers concurrently without taking a lock, a single thread consumes them by
+ * calling run() or run_once(). Handlers of up to handler_capacity bytes are moved into
+ * the inline storage of their cell, larger ones are wrapped in a std::function. Signal
+ * emissions queued via dispatcher() are moved into the cell directly, such that queueing
+ * and executing them does not allocate as long as their arguments fit.
+ *
+ * Producers wait for space while the ring is full, except for handlers that are executed
+ * by the event loop themselves: those would never see the ring drain, the handlers they
+ * dispatch are thus executed right away instead, ahead of the pending ones.
+ *
+ * Instances are meant to be plugged into signal-slot connections via Connection::dispatch_via
+ * and the adaptor returned by dispatcher().
+ */
+class EventLoopDispatcher : private detail::HandlerQueue
+{
+public:
+    /**
+     * @brief Handler refers to the function type executed by the event loop.
+     */
+    typedef std::function<void()> Handler;
+
+    /**
+     * @brief The size in bytes of the inline storage of a single cell.
+     */
+    static constexpr std::size_t handler_capacity = 64;
+
+    /**
+     * @brief EventLoopDispatcher creates a new instance.
+     * @param capacity The maximum number of pending handlers, rounded up to a power of two.
+     */
+    inline explicit EventLoopDispatcher(std::size_t capacity = 1024)
+        : mask(round_up_to_power_of_two(capacity) - 1),
+          cells(new Cell[mask + 1]),
+          enqueue_position(0),
+          dequeue_position(0),
+          consumer(std::thread::id{}),
+          stop_requested(false),
+          consumer_sleeping(false)
+    {
+        for (std::size_t i = 0; i <= mask; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    EventLoopDispatcher(const EventLoopDispatcher&) = delete;
+    EventLoopDispatcher& operator=(const EventLoopDispatcher&) = delete;
+
+    /**
+     * @brief Queries the maximum number of pending handlers.
+     */
+    inline std::size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Queues a handler for execution on the event loop, unless the ring is full.
+     *
+     * Calling this method is thread-safe and lock-free.
+     *
+     * @param handler The handler to be executed, moved into the ring if passed as rvalue.
+     * @return true iff the handler has been queued.
+     */
+    template<typename F>
+    inline bool try_dispatch(F&& handler)
+    {
+        std::size_t position;
+        Cell* cell = claim(position);
+        if (!cell)
+            return false;
+
+        fill(cell, position, [&handler](void* storage) -> const detail::HandlerOperations*
+        {
+            return construct(storage, std::forward<F>(handler), can_store<typename std::decay<F>::type>());
+        });
+
+        return true;
+    }
+
+    /**
+     * @brief Queues a handler for execution on the event loop, waiting for space if the ring is full.
+     *
+     * Called from a handler executed by the event loop while the ring is full, the handler
+     * is executed right away instead of waiting for space that would never become available.
+     *
+     * @param handler The handler to be executed, moved into the ring if passed as rvalue.
+     */
+    template<typename F>
+    inline void dispatch(F&& handler)
+    {
+        std::size_t position;
+        Cell* cell;
+        while (!(cell = claim(position)))
+        {
+            if (on_event_loop())
+            {
+                handler();
+                return;
+            }
+
+            std::this_thread::yield();
+        }
+
+        fill(cell, position, [&handler](void* storage) -> const detail::HandlerOperations*
+        {
+            return construct(storage, std::forward<F>(handler), can_store<typename std::decay<F>::type>());
+        });
+    }
+
+    /**
+     * @brief Returns an adaptor suitable for Connection::dispatch_via.
+     *
+     * The adaptor refers to this instance, which has to outlive all connections using it.
+     * Emissions queue like dispatch(), in particular emissions from handlers executed by
+     * the event loop are executed right away if the ring is full.
+     */
+    inline Connection::Dispatcher dispatcher()
+    {
+        return adaptor();
+    }
+
+    /**
+     * @brief Executes all handlers that are pending at the time of the call, without blocking.
+     *
+     * Must only be called from a single thread at a time.
+     *
+     * @return The number of handlers executed.
+     */
+    inline std::size_t run_once()
+    {
+        // Restores the thread of an outer run_once() call, for handlers running the loop.
+        struct Consumer
+        {
+            inline explicit Consumer(std::atomic<std::thread::id>& consumer)
+                : consumer(consumer),
+                  previous(consumer.exchange(std::this_thread::get_id(), std::memory_order_relaxed))
+            {
+            }
+
+            inline ~Consumer()
+            {
+                consumer.store(previous, std::memory_order_relaxed);
+            }
+
+            std::atomic<std::thread::id>& consumer;
+            std::thread::id previous;
+        } scope{consumer};
+
+        std::size_t end = enqueue_position.load(std::memory_order_acquire);
+        std::size_t count = 0;
+
+        while (dequeue_position != end && execute_next())
+            count++;
+
+        return count;
+    }
+
+    /**
+     * @brief Executes handlers as they arrive until stop() is called.
+     *
+     * Must only be called from a single thread at a time.
+     */
+    inline void run()
+    {
+        while (!stop_requested.load())
+        {
+            if (run_once() > 0)
+                continue;
+
+            consumer_sleeping.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            {
+                std::unique_lock<std::mutex> ul(guard);
+                wait_condition.wait_for(
+                            ul,
+                            std::chrono::milliseconds{500},
+                            [this]() { return stop_requested.load() || !empty(); });
+            }
+
+            consumer_sleeping.store(false);
+        }
+
+        stop_requested.store(false);
+    }
+
+    /**
+     * @brief Requests a running event loop to return. Thread-safe.
+     */
+    inline void stop()
+    {
+        stop_requested.store(true);
+
+        std::lock_guard<std::mutex> lg(guard);
+        wait_condition.notify_all();
+    }
+
+private:
+    typedef std::aligned_storage<handler_capacity>::type Storage;
+
+    static_assert(sizeof(Handler) <= sizeof(Storage), "Cells have to be able to hold any Handler.");
+
+    struct Cell
+    {
+        inline ~Cell()
+        {
+            if (operations)
+                operations->destroy(&storage);
+        }
+
+        std::atomic<std::size_t> sequence;
+        // The operations on the handler stored inline, nullptr if the cell is empty.
+        const detail::HandlerOperations* operations = nullptr;
+        Storage storage;
+    };
+
+    template<typename H>
+    static constexpr std::integral_constant<bool, sizeof(H) <= sizeof(Storage) && alignof(Storage) % alignof(H) == 0>
+    can_store()
+    {
+        return {};
+    }
+
+    template<typename F>
+    static inline const detail::HandlerOperations* construct(void* storage, F&& handler, std::true_type)
+    {
+        typedef typename std::decay<F>::type H;
+
+        new (storage) H(std::forward<F>(handler));
+        return &detail::HandlerOperationsFor<H>::table;
+    }
+
+    template<typename F>
+    static inline const detail::HandlerOperations* construct(void* storage, F&& handler, std::false_type)
+    {
+        new (storage) Handler(std::forward<F>(handler));
+        return &detail::HandlerOperationsFor<Handler>::table;
+    }
+
+    // Moves a handler of a signal emission into the ring, see detail::HandlerQueue.
+    inline void enqueue(void* handler, const detail::HandlerOperations& operations) override
+    {
+        std::size_t position;
+        Cell* cell;
+        while (!(cell = claim(position)))
+        {
+            if (on_event_loop())
+            {
+                operations.invoke(handler);
+                return;
+            }
+
+            std::this_thread::yield();
+        }
+
+        fill(cell, position, [handler, &operations](void* storage) -> const detail::HandlerOperations*
+        {
+            if (operations.size <= sizeof(Storage) && alignof(Storage) % operations.alignment == 0)
+            {
+                operations.move_to(handler, storage);
+                return &operations;
+            }
+
+            new (storage) Handler(operations.wrap(handler));
+            return &detail::HandlerOperationsFor<Handler>::table;
+        });
+    }
+
+    // Claims the next cell for a producer, returns nullptr if the ring is full.
+    inline Cell* claim(std::size_t& position)
+    {
+        position = enqueue_position.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Cell* cell = &cells[position & mask];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+            if (difference == 0)
+            {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    return cell;
+            } else if (difference < 0)
+            {
+                return nullptr;
+            } else
+            {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Constructs the handler in a claimed cell and publishes it to the consumer. The cell
+    // is published empty if constructing the handler throws, such that the ring keeps going.
+    template<typename Constructor>
+    inline void fill(Cell* cell, std::size_t position, const Constructor& constructor)
+    {
+        try
+        {
+            cell->operations = constructor(&cell->storage);
+        } catch(...)
+        {
+            cell->operations = nullptr;
+            cell->sequence.store(position + 1, std::memory_order_release);
+            throw;
+        }
+
+        cell->sequence.store(position + 1, std::memory_order_release);
+
+        wake_up_consumer();
+    }
+
+    static inline std::size_t round_up_to_power_of_two(std::size_t n)
+    {
+        std::size_t result = 2;
+        while (result < n)
+            result <<= 1;
+
+        return result;
+    }
+
+    inline bool empty() const
+    {
+        const Cell& cell = cells[dequeue_position & mask];
+        return cell.sequence.load(std::memory_order_acquire) != dequeue_position + 1;
+    }
+
+    inline bool execute_next()
+    {
+        if (empty())
+            return false;
+
+        Cell& cell = cells[dequeue_position & mask];
+
+        // The cell is released to producers even if the handler throws.
+        struct Release
+        {
+            ~Release()
+            {
+                if (cell.operations)
+                    cell.operations->destroy(&cell.storage);
+
+                cell.operations = nullptr;
+                cell.sequence.store(position + mask + 1, std::memory_order_release);
+            }
+
+            Cell& cell;
+            std::size_t position;
+            std::size_t mask;
+        } release{cell, dequeue_position++, mask};
+
+        if (cell.operations)
+            cell.operations->invoke(&cell.storage);
+
+        return true;
+    }
+
+    // Checks if the calling thread is executing handlers of this instance.
+    inline bool on_event_loop() const
+    {
+        return consumer.load(std::memory_order_relaxed) == std::this_thread::get_id();
+    }
+
+    inline void wake_up_consumer()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (consumer_sleeping.load())
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            wait_condition.notify_one();
+        }
+    }
+
+    const std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+
+    // Producer and consumer positions live on separate cache lines.
+    char enqueue_position_padding[64];
+    std::atomic<std::size_t> enqueue_position;
+    char dequeue_position_padding[64];
+    std::size_t dequeue_position;
+    // The thread executing handlers, default-constructed while there is none.
+    std::atomic<std::thread::id> consumer;
+
+    std::atomic<bool> stop_requested;
+    std::atomic<bool> consumer_sleeping;
+    std::mutex guard;
+    std::condition_variable wait_condition;
+};
+}
+
+#endif // CORE_EVENT_LOOP_DISPATCHER_H_
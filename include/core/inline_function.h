@@ -0,0 +1,184 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_INLINE_FUNCTION_H_
+#define CORE_INLINE_FUNCTION_H_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace core
+{
+template<typename Signature, std::size_t Size>
+class InlineFunction;
+
+/**
+ * @brief A copyable function wrapper that stores its target in a fixed-size inline buffer.
+ *
+ * In contrast to std::function, InlineFunction never allocates. Constructing an instance
+ * from a callable that does not fit into the inline buffer results in a compile-time error.
+ *
+ * @tparam R The return type of the function.
+ * @tparam Args The argument types of the function.
+ * @tparam Size The size of the inline buffer in bytes.
+ */
+template<typename R, typename... Args, std::size_t Size>
+class InlineFunction<R(Args...), Size>
+{
+public:
+    /**
+     * @brief Checks at compile time whether a callable of type F can be stored inline.
+     */
+    template<typename F>
+    static constexpr bool can_store()
+    {
+        return sizeof(F) <= Size && alignof(Storage) % alignof(F) == 0;
+    }
+
+    /**
+     * @brief Constructs an empty instance. Never throws.
+     */
+    inline InlineFunction() noexcept(true) : ops(nullptr)
+    {
+    }
+
+    /**
+     * @brief Constructs an instance from an arbitrary callable.
+     *
+     * Fails to compile if the callable does not fit into the inline buffer.
+     *
+     * @param f The callable to be stored.
+     */
+    template<
+        typename F,
+        typename = typename std::enable_if<
+            !std::is_same<typename std::decay<F>::type, InlineFunction>::value
+        >::type
+    >
+    inline InlineFunction(F&& f) : ops(nullptr)
+    {
+        typedef typename std::decay<F>::type Callable;
+
+        static_assert(sizeof(Callable) <= Size,
+                      "Callable exceeds the inline capacity of InlineFunction.");
+        static_assert(alignof(Storage) % alignof(Callable) == 0,
+                      "Callable is over-aligned for the inline storage of InlineFunction.");
+
+        new (&storage) Callable(std::forward<F>(f));
+        ops = &Operations<Callable>::table;
+    }
+
+    inline InlineFunction(const InlineFunction& rhs) : ops(rhs.ops)
+    {
+        if (ops)
+            ops->copy(&storage, &rhs.storage);
+    }
+
+    inline ~InlineFunction()
+    {
+        if (ops)
+            ops->destroy(&storage);
+    }
+
+    inline InlineFunction& operator=(const InlineFunction& rhs)
+    {
+        if (this != &rhs)
+        {
+            if (ops)
+                ops->destroy(&storage);
+
+            ops = nullptr;
+
+            if (rhs.ops)
+                rhs.ops->copy(&storage, &rhs.storage);
+
+            ops = rhs.ops;
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Checks if this instance stores a callable.
+     */
+    inline explicit operator bool() const
+    {
+        return ops != nullptr;
+    }
+
+    /**
+     * @brief Invokes the stored callable.
+     * @throw std::bad_function_call if the instance is empty.
+     */
+    inline R operator()(Args... args) const
+    {
+        if (!ops)
+            throw std::bad_function_call();
+
+        return ops->invoke(&storage, std::forward<Args>(args)...);
+    }
+
+private:
+    typedef typename std::aligned_storage<Size>::type Storage;
+
+    struct Table
+    {
+        R (*invoke)(const void*, Args&&...);
+        void (*copy)(void*, const void*);
+        void (*destroy)(void*);
+    };
+
+    template<typename Callable>
+    struct Operations
+    {
+        static R invoke(const void* p, Args&&... args)
+        {
+            return (*static_cast<Callable*>(const_cast<void*>(p)))(std::forward<Args>(args)...);
+        }
+
+        static void copy(void* to, const void* from)
+        {
+            new (to) Callable(*static_cast<const Callable*>(from));
+        }
+
+        static void destroy(void* p)
+        {
+            static_cast<Callable*>(p)->~Callable();
+        }
+
+        static const Table table;
+    };
+
+    Storage storage;
+    const Table* ops;
+};
+
+template<typename R, typename... Args, std::size_t Size>
+template<typename Callable>
+const typename InlineFunction<R(Args...), Size>::Table
+InlineFunction<R(Args...), Size>::Operations<Callable>::table =
+{
+    &InlineFunction<R(Args...), Size>::Operations<Callable>::invoke,
+    &InlineFunction<R(Args...), Size>::Operations<Callable>::copy,
+    &InlineFunction<R(Args...), Size>::Operations<Callable>::destroy
+};
+}
+
+#endif // CORE_INLINE_FUNCTION_H_
@@ -0,0 +1,446 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_INSTRUMENTATION_H_
+#define CORE_INSTRUMENTATION_H_
+
+/**
+ * @brief Define PROPERTIES_CPP_ENABLE_INSTRUMENTATION to 1 before including any header
+ * of this library to collect emission statistics for all signals. If left undefined,
+ * all instrumentation compiles down to nothing. The setting has to be consistent across
+ * all translation units of a program.
+ */
+#ifndef PROPERTIES_CPP_ENABLE_INSTRUMENTATION
+#define PROPERTIES_CPP_ENABLE_INSTRUMENTATION 0
+#endif
+
+#include <cstddef>
+#include <string>
+
+#if PROPERTIES_CPP_ENABLE_INSTRUMENTATION
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#endif
+
+namespace core
+{
+#if PROPERTIES_CPP_ENABLE_INSTRUMENTATION
+namespace instrumentation
+{
+/**
+ * @brief A histogram of durations with power-of-two nanosecond buckets.
+ *
+ * Bucket i counts durations d with 2^(i-1) <= d < 2^i nanoseconds, bucket 0 counts durations below 1ns.
+ * Recording is wait-free and thread-safe.
+ */
+class Histogram
+{
+public:
+    static constexpr std::size_t bucket_count = 48;
+
+    inline Histogram()
+    {
+        for (auto& bucket : buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    /**
+     * @brief Records a single duration.
+     */
+    inline void record(const std::chrono::nanoseconds& duration)
+    {
+        std::uint64_t ns = duration.count() > 0 ? static_cast<std::uint64_t>(duration.count()) : 0;
+
+        std::size_t i = 0;
+        while (ns > 0 && i < bucket_count - 1)
+        {
+            ns >>= 1;
+            i++;
+        }
+
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Queries the number of durations recorded in bucket i.
+     */
+    inline std::size_t bucket(std::size_t i) const
+    {
+        return buckets[i].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Queries the total number of durations recorded.
+     */
+    inline std::size_t count() const
+    {
+        std::size_t result = 0;
+        for (const auto& bucket : buckets)
+            result += bucket.load(std::memory_order_relaxed);
+
+        return result;
+    }
+
+private:
+    std::atomic<std::size_t> buckets[bucket_count];
+};
+
+/**
+ * @brief Emission statistics of a single signal. All accessors are thread-safe.
+ */
+class SignalStatistics
+{
+public:
+    inline explicit SignalStatistics(const std::string& name)
+        : signal_name(name),
+          emissions(0),
+          invocations(0),
+          connected_slots(0),
+          guard_hold_time(0)
+    {
+    }
+
+    SignalStatistics(const SignalStatistics&) = delete;
+    SignalStatistics& operator=(const SignalStatistics&) = delete;
+
+    /** @brief The name the signal has been constructed with, empty if unnamed. */
+    inline const std::string& name() const { return signal_name; }
+    /** @brief The number of times the signal has been emitted. */
+    inline std::size_t emit_count() const { return emissions.load(); }
+    /** @brief The number of slot invocations across all emissions. */
+    inline std::size_t invocation_count() const { return invocations.load(); }
+    /** @brief The number of currently connected slots. */
+    inline std::size_t slot_count() const { return connected_slots.load(); }
+
+    /** @brief The accumulated time the guard of the signal has been held by connect and disconnect operations. */
+    inline std::chrono::nanoseconds guard_hold_duration() const
+    {
+        return std::chrono::nanoseconds{guard_hold_time.load()};
+    }
+
+    /**
+     * @brief Returns the execution time histograms of all connected slots, keyed by slot id.
+     */
+    inline std::vector<std::pair<std::size_t, std::shared_ptr<const Histogram>>> slot_histograms() const
+    {
+        std::lock_guard<std::mutex> lg(guard);
+        return std::vector<std::pair<std::size_t, std::shared_ptr<const Histogram>>>(
+                    histograms.begin(),
+                    histograms.end());
+    }
+
+    inline void record_emission()
+    {
+        emissions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void record_invocation()
+    {
+        invocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void record_guard_hold(const std::chrono::nanoseconds& duration)
+    {
+        guard_hold_time.fetch_add(duration.count(), std::memory_order_relaxed);
+    }
+
+    inline std::shared_ptr<Histogram> add_slot(std::size_t id)
+    {
+        auto histogram = std::make_shared<Histogram>();
+
+        std::lock_guard<std::mutex> lg(guard);
+        histograms[id] = histogram;
+        connected_slots++;
+
+        return histogram;
+    }
+
+    inline void remove_slot(std::size_t id)
+    {
+        std::lock_guard<std::mutex> lg(guard);
+        if (histograms.erase(id) > 0)
+            connected_slots--;
+    }
+
+private:
+    std::string signal_name;
+    std::atomic<std::size_t> emissions;
+    std::atomic<std::size_t> invocations;
+    std::atomic<std::size_t> connected_slots;
+    std::atomic<std::int64_t> guard_hold_time;
+    mutable std::mutex guard;
+    std::map<std::size_t, std::shared_ptr<const Histogram>> histograms;
+};
+
+/**
+ * @brief Enumerates the statistics of all live signals. Thread-safe.
+ */
+class Registry
+{
+public:
+    /**
+     * @brief Accesses the process-wide registry.
+     */
+    static inline Registry& instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Returns the statistics of all signals alive at the time of the call.
+     */
+    inline std::vector<std::shared_ptr<const SignalStatistics>> signals() const
+    {
+        std::lock_guard<std::mutex> lg(guard);
+        return std::vector<std::shared_ptr<const SignalStatistics>>(entries.begin(), entries.end());
+    }
+
+    inline void add(const std::shared_ptr<const SignalStatistics>& statistics)
+    {
+        std::lock_guard<std::mutex> lg(guard);
+        entries.push_back(statistics);
+    }
+
+    inline void remove(const std::shared_ptr<const SignalStatistics>& statistics)
+    {
+        std::lock_guard<std::mutex> lg(guard);
+        entries.erase(std::remove(entries.begin(), entries.end(), statistics), entries.end());
+    }
+
+private:
+    Registry() = default;
+
+    mutable std::mutex guard;
+    std::vector<std::shared_ptr<const SignalStatistics>> entries;
+};
+}
+#endif
+
+namespace detail
+{
+#if PROPERTIES_CPP_ENABLE_INSTRUMENTATION
+// Measures the lifetime of an instance and reports it to the given function on destruction.
+template<typename Recorder>
+class ScopedTimer
+{
+public:
+    inline explicit ScopedTimer(const Recorder& recorder)
+        : recorder(recorder),
+          start(std::chrono::steady_clock::now()),
+          active(true)
+    {
+    }
+
+    inline ScopedTimer(ScopedTimer&& rhs)
+        : recorder(rhs.recorder),
+          start(rhs.start),
+          active(rhs.active)
+    {
+        rhs.active = false;
+    }
+
+    inline ~ScopedTimer()
+    {
+        if (active)
+            recorder(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - start));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Recorder recorder;
+    std::chrono::steady_clock::time_point start;
+    bool active;
+};
+
+// Instruments the invocations of a single slot.
+class SlotProbe
+{
+public:
+    struct Recorder
+    {
+        inline void operator()(const std::chrono::nanoseconds& duration) const
+        {
+            if (statistics)
+                statistics->record_invocation();
+            if (histogram)
+                histogram->record(duration);
+        }
+
+        instrumentation::SignalStatistics* statistics;
+        instrumentation::Histogram* histogram;
+    };
+
+    inline SlotProbe() = default;
+
+    inline SlotProbe(const std::shared_ptr<instrumentation::SignalStatistics>& statistics,
+                     const std::shared_ptr<instrumentation::Histogram>& histogram)
+        : statistics(statistics),
+          histogram(histogram)
+    {
+    }
+
+    inline ScopedTimer<Recorder> time() const
+    {
+        return ScopedTimer<Recorder>{Recorder{statistics.get(), histogram.get()}};
+    }
+
+private:
+    std::shared_ptr<instrumentation::SignalStatistics> statistics;
+    std::shared_ptr<instrumentation::Histogram> histogram;
+};
+
+// Instruments a single signal, registered with the instrumentation::Registry while alive.
+class SignalProbe
+{
+public:
+    struct GuardRecorder
+    {
+        inline void operator()(const std::chrono::nanoseconds& duration) const
+        {
+            statistics->record_guard_hold(duration);
+        }
+
+        instrumentation::SignalStatistics* statistics;
+    };
+
+    inline explicit SignalProbe(const std::string& name)
+        : statistics(std::make_shared<instrumentation::SignalStatistics>(name)),
+          id_prefix(0),
+          registered(true)
+    {
+        instrumentation::Registry::instance().add(statistics);
+    }
+
+    // Reports to the statistics of parent instead of registering statistics of its own.
+    // Slot ids are qualified by ordinal, which has to be non-zero and unique among the
+    // probes sharing parent, to keep them apart from the slot ids of parent.
+    inline SignalProbe(const SignalProbe& parent, std::size_t ordinal)
+        : statistics(parent.statistics),
+          id_prefix(ordinal),
+          registered(false)
+    {
+    }
+
+    inline ~SignalProbe()
+    {
+        retire();
+    }
+
+    SignalProbe(const SignalProbe&) = delete;
+    SignalProbe& operator=(const SignalProbe&) = delete;
+
+    inline void retire()
+    {
+        if (registered)
+            instrumentation::Registry::instance().remove(statistics);
+    }
+
+    inline SlotProbe slot_connected(std::size_t id)
+    {
+        return SlotProbe{statistics, statistics->add_slot(qualified(id))};
+    }
+
+    inline void slot_disconnected(std::size_t id)
+    {
+        statistics->remove_slot(qualified(id));
+    }
+
+    inline void emitted()
+    {
+        statistics->record_emission();
+    }
+
+    inline ScopedTimer<GuardRecorder> time_guard()
+    {
+        return ScopedTimer<GuardRecorder>{GuardRecorder{statistics.get()}};
+    }
+
+private:
+    // Places the prefix in the upper half of the id, slot ids are generation table indices.
+    inline std::size_t qualified(std::size_t id) const
+    {
+        return (id_prefix << (sizeof(std::size_t) * 4)) | id;
+    }
+
+    std::shared_ptr<instrumentation::SignalStatistics> statistics;
+    std::size_t id_prefix;
+    bool registered;
+};
+#else
+struct NullTimer
+{
+};
+
+struct SlotProbe
+{
+    inline NullTimer time() const
+    {
+        return NullTimer{};
+    }
+};
+
+struct SignalProbe
+{
+    inline explicit SignalProbe(const std::string&)
+    {
+    }
+
+    inline SignalProbe(const SignalProbe&, std::size_t)
+    {
+    }
+
+    inline void retire()
+    {
+    }
+
+    inline SlotProbe slot_connected(std::size_t)
+    {
+        return SlotProbe{};
+    }
+
+    inline void slot_disconnected(std::size_t)
+    {
+    }
+
+    inline void emitted()
+    {
+    }
+
+    inline NullTimer time_guard()
+    {
+        return NullTimer{};
+    }
+};
+#endif
+}
+}
+
+#endif // CORE_INSTRUMENTATION_H_
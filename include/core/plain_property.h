@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_PLAIN_PROPERTY_H_
+#define CORE_PLAIN_PROPERTY_H_
+
+#include <core/equality_policy.h>
+#include <core/signal.h>
+#include <core/transaction.h>
+
+#include <utility>
+
+namespace core
+{
+/**
+ * @brief A property without virtual dispatch and without getter or setter hooks.
+ *
+ * Accessing the value is a plain member access, and setting it costs a comparison, the
+ * assignment and an emission of the changed signal, which is close to free while nobody
+ * observes the property. Use Property instead if get and set operations have to be
+ * dispatched to functors, or if the property is to be specialized by subclasses.
+ *
+ * Just like for Property, change notifications within a core::Transaction are coalesced,
+ * and no thread-safety guarantees are given.
+ *
+ * @tparam T The type of the value contained within the property.
+ * @tparam EqualityPolicy Decides whether a new value equals the contained one, ByValue by default.
+ */
+template<typename T, typename EqualityPolicy = ByValue>
+class PlainProperty final
+{
+  public:
+    /**
+     * @brief ValueType refers to the type of the contained value.
+     */
+    typedef T ValueType;
+
+    /**
+     * @brief PlainProperty creates a new instance and initializes the contained value.
+     * @param t The initial value.
+     */
+    inline explicit PlainProperty(const T& t = T{}) : value{t}, notification_pending{false}
+    {
+    }
+
+    /**
+     * @brief PlainProperty creates a new instance and moves the initial value into it.
+     * @param t The initial value.
+     */
+    inline explicit PlainProperty(T&& t) : value{std::move(t)}, notification_pending{false}
+    {
+    }
+
+    /**
+     * @brief Copy c'tor, only copies the contained value, not the changed signal and its connections.
+     * @param rhs
+     */
+    inline PlainProperty(const PlainProperty& rhs) : value{rhs.value}, notification_pending{false}
+    {
+    }
+
+    inline ~PlainProperty()
+    {
+        if (notification_pending)
+            Transaction::cancel(this);
+    }
+
+    /**
+     * @brief Assignment operator, only assigns to the contained value.
+     * @param rhs The right-hand-side, raw value to assign to this property.
+     */
+    inline PlainProperty& operator=(const T& rhs)
+    {
+        set(rhs);
+        return *this;
+    }
+
+    /**
+     * @brief Assignment operator, only assigns to the contained value, not the changed signal and its connections.
+     * @param rhs The right-hand-side property to assign from.
+     */
+    inline PlainProperty& operator=(const PlainProperty& rhs)
+    {
+        set(rhs.value);
+        return *this;
+    }
+
+    /**
+     * @brief Explicit casting operator to the contained value type.
+     * @return A non-mutable reference to the contained value.
+     */
+    inline operator const T&() const
+    {
+        return value;
+    }
+
+    /**
+     * @brief Provides access to a pointer to the contained value.
+     */
+    inline const T* operator->() const
+    {
+        return &value;
+    }
+
+    /**
+     * @brief Access the value contained within this property.
+     * @return A non-mutable reference to the property value.
+     */
+    inline const T& get() const
+    {
+        return value;
+    }
+
+    /**
+     * @brief Set the contained value to the provided value. Notify observers of the change.
+     * @param [in] new_value The new value to assign to this property.
+     */
+    inline void set(const T& new_value)
+    {
+        if (EqualityPolicy::equal(value, new_value))
+            return;
+
+        value = new_value;
+        notify_changed();
+    }
+
+    /**
+     * @brief Move the provided value into this property. Notify observers of the change.
+     * @param [in] new_value The new value to move into this property.
+     */
+    inline void set(T&& new_value)
+    {
+        if (EqualityPolicy::equal(value, new_value))
+            return;
+
+        value = std::move(new_value);
+        notify_changed();
+    }
+
+    /**
+     * @brief Applies the update functor to the contained value, notifying observers if it returns true.
+     * @param update_functor Invocable with a T&, returns true iff it changed the value.
+     * @return true iff application of the update functor has been successful.
+     */
+    template<typename UpdateFunctor>
+    inline bool update(UpdateFunctor update_functor)
+    {
+        if (!update_functor(value))
+            return false;
+
+        notify_changed();
+        return true;
+    }
+
+    /**
+     * @brief Access to the changed signal, allows observers to subscribe to change notifications.
+     * @return A non-mutable reference to the changed signal.
+     */
+    inline const Signal<T>& changed() const
+    {
+        return signal_changed;
+    }
+
+  private:
+    inline void notify_changed()
+    {
+        if (!Transaction::is_active())
+        {
+            signal_changed(value);
+            return;
+        }
+
+        if (notification_pending)
+            return;
+
+        notification_pending = true;
+        Transaction::defer(this, [this]()
+        {
+            notification_pending = false;
+            signal_changed(value);
+        });
+    }
+
+    T value;
+    bool notification_pending;
+    Signal<T> signal_changed;
+};
+}
+
+#endif // CORE_PLAIN_PROPERTY_H_
@@ -0,0 +1,215 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_POOL_ALLOCATOR_H_
+#define CORE_POOL_ALLOCATOR_H_
+
+#include <cstddef>
+#include <new>
+
+namespace core
+{
+namespace detail
+{
+/**
+ * @brief A per-thread cache of memory blocks, binned into power-of-two size classes.
+ *
+ * Freed blocks are kept on the free list of the freeing thread and handed out again by
+ * subsequent allocations of the same size class on that thread. Blocks are obtained from
+ * and eventually returned to the global operator new, such that they can be freed on any
+ * thread. Requests beyond the largest size class bypass the cache.
+ */
+class BlockPool
+{
+public:
+    static constexpr std::size_t smallest_block_size = 64;
+    static constexpr std::size_t size_class_count = 8;
+    static constexpr std::size_t max_cached_blocks = 32;
+
+    /**
+     * @brief Accesses the pool of the calling thread.
+     */
+    static inline BlockPool& local()
+    {
+        static thread_local BlockPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Allocates a block of at least size bytes.
+     */
+    static inline void* allocate(std::size_t size)
+    {
+        std::size_t size_class = size_class_for(size);
+        if (size_class == size_class_count || destroyed())
+            return ::operator new(block_size(size_class, size));
+
+        return local().pop(size_class);
+    }
+
+    /**
+     * @brief Frees a block previously allocated with the same size, on any thread.
+     */
+    static inline void deallocate(void* p, std::size_t size)
+    {
+        std::size_t size_class = size_class_for(size);
+        if (size_class == size_class_count || destroyed())
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        local().push(size_class, p);
+    }
+
+    inline ~BlockPool()
+    {
+        destroyed() = true;
+
+        for (auto head : free_lists)
+        {
+            while (head)
+            {
+                FreeBlock* next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    inline BlockPool()
+    {
+        for (std::size_t i = 0; i < size_class_count; i++)
+        {
+            free_lists[i] = nullptr;
+            cached_blocks[i] = 0;
+        }
+    }
+
+    // Trivially destructible, thus still accessible while other thread-local objects are destroyed.
+    static inline bool& destroyed()
+    {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    static inline std::size_t size_class_for(std::size_t size)
+    {
+        std::size_t size_class = 0;
+        std::size_t block = smallest_block_size;
+
+        while (block < size && size_class < size_class_count)
+        {
+            block <<= 1;
+            size_class++;
+        }
+
+        return size_class;
+    }
+
+    static inline std::size_t block_size(std::size_t size_class, std::size_t size)
+    {
+        return size_class == size_class_count ? size : smallest_block_size << size_class;
+    }
+
+    inline void* pop(std::size_t size_class)
+    {
+        FreeBlock* block = free_lists[size_class];
+        if (!block)
+            return ::operator new(block_size(size_class, 0));
+
+        free_lists[size_class] = block->next;
+        cached_blocks[size_class]--;
+        return block;
+    }
+
+    inline void push(std::size_t size_class, void* p)
+    {
+        if (cached_blocks[size_class] == max_cached_blocks)
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = free_lists[size_class];
+        free_lists[size_class] = block;
+        cached_blocks[size_class]++;
+    }
+
+    FreeBlock* free_lists[size_class_count];
+    std::size_t cached_blocks[size_class_count];
+};
+}
+
+/**
+ * @brief A stateless allocator that serves memory from the per-thread detail::BlockPool.
+ *
+ * Suited for the short-lived, similarly sized allocations made by signals on connect and
+ * disconnect, see PooledSlots.
+ *
+ * @tparam T The type of the objects to allocate memory for.
+ */
+template<typename T>
+class PoolAllocator
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t), "PoolAllocator does not support over-aligned types");
+
+public:
+    typedef T value_type;
+
+    inline PoolAllocator() noexcept(true) = default;
+
+    template<typename U>
+    inline PoolAllocator(const PoolAllocator<U>&) noexcept(true)
+    {
+    }
+
+    inline T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(detail::BlockPool::allocate(n * sizeof(T)));
+    }
+
+    inline void deallocate(T* p, std::size_t n)
+    {
+        detail::BlockPool::deallocate(p, n * sizeof(T));
+    }
+
+    template<typename U>
+    inline bool operator==(const PoolAllocator<U>&) const
+    {
+        return true;
+    }
+
+    template<typename U>
+    inline bool operator!=(const PoolAllocator<U>&) const
+    {
+        return false;
+    }
+};
+}
+
+#endif // CORE_POOL_ALLOCATOR_H_
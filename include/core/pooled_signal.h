@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_POOLED_SIGNAL_H_
+#define CORE_POOLED_SIGNAL_H_
+
+#include <core/pool_allocator.h>
+#include <core/signal.h>
+
+namespace core
+{
+/**
+ * @brief Slot policy that allocates slot list snapshots from the per-thread block pool.
+ *
+ * Connecting and disconnecting replaces the slot list snapshot of a signal. With this
+ * policy, the memory for snapshots and the shared_ptr control blocks managing them is
+ * recycled through PoolAllocator instead of going back to the global heap.
+ *
+ * @tparam BasePolicy Determines how slots themselves are stored, e.g. DynamicSlots or InlineSlots.
+ */
+template<typename BasePolicy = DynamicSlots>
+struct PooledSlots : public BasePolicy
+{
+    template<typename T>
+    using Allocator = PoolAllocator<T>;
+};
+
+/**
+ * @brief A signal class whose slot list snapshots are allocated from the per-thread block pool.
+ * @tparam Arguments List of argument types passed on to observers when the signal is emitted.
+ */
+template<typename ...Arguments>
+class PooledSignal : public BasicSignal<PooledSlots<>, Arguments...>
+{
+public:
+    /**
+     * @brief PooledSignal constructs a new instance. Never throws.
+     */
+    inline PooledSignal() noexcept(true)
+    {
+    }
+
+    /**
+     * @brief PooledSignal constructs a new, named instance, see BasicSignal.
+     * @param name The name of the signal.
+     */
+    inline explicit PooledSignal(const std::string& name) : BasicSignal<PooledSlots<>, Arguments...>(name)
+    {
+    }
+};
+}
+
+#endif // CORE_POOLED_SIGNAL_H_
@@ -18,9 +18,14 @@
 #ifndef CORE_PROPERTY_H_
 #define CORE_PROPERTY_H_
 
+#include <core/connection_group.h>
+#include <core/equality_policy.h>
 #include <core/signal.h>
+#include <core/transaction.h>
 
-#include <set>
+#include <chrono>
+#include <cstddef>
+#include <utility>
 
 namespace core
 {
@@ -31,9 +36,20 @@ namespace core
  * That is, consumers must not assume that concurrent get() and set() operations are synchronized by
  * this class.
  *
- * @tparam The type of the value contained within the property.
+ * Change notifications of properties modified within a core::Transaction are coalesced and
+ * delivered once, with the final value, when the outermost transaction commits.
+ *
+ * Whether set() actually changes the property is decided by the equality policy, e.g. to
+ * compare version stamps instead of deeply nested values, see core/equality_policy.h.
+ *
+ * get() and set() are virtual and check for installed functors with every language standard,
+ * as subclasses may override them. Use core::PlainProperty where a property has to compile
+ * down to a plain member access.
+ *
+ * @tparam T The type of the value contained within the property.
+ * @tparam EqualityPolicy Decides whether a new value equals the contained one, ByValue by default.
  */
-template<typename T>
+template<typename T, typename EqualityPolicy = ByValue>
 class Property
 {
   public:
@@ -52,14 +68,57 @@ class Property
      */
     typedef std::function<void(const ValueType&)> Setter;
 
+    /**
+     * @brief Duration refers to the time-to-live of cached getter results.
+     */
+    typedef std::chrono::steady_clock::duration Duration;
+
+    /**
+     * @brief CacheStatistics summarizes the effectiveness of a cached getter.
+     */
+    struct CacheStatistics
+    {
+        /** @brief Number of get operations answered from the cache. */
+        std::size_t hits;
+        /** @brief Number of get operations that invoked the getter. */
+        std::size_t misses;
+    };
+
+    /**
+     * @brief Time-to-live for cached getter results that only expire on invalidate().
+     */
+    static constexpr Duration until_invalidated()
+    {
+        return Duration::max();
+    }
+
     /**
      * @brief Property creates a new instance of property and initializes the contained value.
-     * @param t The initial value, defaults to Property<T>::default_value().
+     * @param t The initial value, defaults to T{}.
      */
     inline explicit Property(const T& t = T{})
             : value{t},
               getter{},
-              setter{}
+              setter{},
+              cache{},
+              notification_pending{false},
+              movable_value{nullptr},
+              dispatching{false}
+    {
+    }
+
+    /**
+     * @brief Property creates a new instance of property and moves the initial value into it.
+     * @param t The initial value.
+     */
+    inline explicit Property(T&& t)
+            : value{std::move(t)},
+              getter{},
+              setter{},
+              cache{},
+              notification_pending{false},
+              movable_value{nullptr},
+              dispatching{false}
     {
     }
 
@@ -67,11 +126,20 @@ class Property
      * @brief Copy c'tor, only copies the contained value, not the changed signal and its connections.
      * @param rhs
      */
-    inline Property(const Property<T>& rhs) : value{rhs.value}
+    inline Property(const Property& rhs)
+            : value{rhs.value},
+              cache{},
+              notification_pending{false},
+              movable_value{nullptr},
+              dispatching{false}
     {
     }
 
-    inline virtual ~Property() = default;
+    inline virtual ~Property()
+    {
+        if (notification_pending)
+            Transaction::cancel(this);
+    }
 
     /**
      * @brief Assignment operator, only assigns to the contained value.
@@ -83,11 +151,21 @@ class Property
         return *this;
     }
 
+    /**
+     * @brief Assignment operator, only assigns to the contained value by moving from rhs.
+     * @param rhs The right-hand-side, raw value to move into this property.
+     */
+    inline Property& operator=(T&& rhs)
+    {
+        set(std::move(rhs));
+        return *this;
+    }
+
     /**
      * @brief Assignment operator, only assigns to the contained value, not the changed signal and its connections.
      * @param rhs The right-hand-side property to assign from.
      */
-    inline Property& operator=(const Property<T>& rhs)
+    inline Property& operator=(const Property& rhs)
     {
         set(rhs.value);
         return *this;
@@ -116,7 +194,7 @@ class Property
      * @param rhs Non-mutable reference to a raw value.
      * @return True iff the value contained in lhs equals rhs.
      */
-    friend inline bool operator==(const Property<T>& lhs, const T& rhs)
+    friend inline bool operator==(const Property& lhs, const T& rhs)
     {
         return lhs.get() == rhs;
     }
@@ -127,27 +205,79 @@ class Property
      * @param rhs Non-mutable reference to a property.
      * @return True iff the value contained in lhs equals the value contained in rhs.
      */
-    friend inline bool operator==(const Property<T>& lhs, const Property<T>& rhs)
+    friend inline bool operator==(const Property& lhs, const Property& rhs)
     {
         return lhs.get() == rhs.get();
     }
 
     /**
      * @brief Set the contained value to the provided value. Notify observers of the change.
+     *
+     * This is the single overridable entry point for all set operations, rvalues handed to
+     * set(T&&), operator= and emplace() end up here, too.
+     *
      * @param [in] new_value The new value to assign to this property.
      * @post get() == new_value;
      */
     inline virtual void set(const T& new_value)
     {
-        if (value != new_value)
+        dispatching = false;
+
+        if (!EqualityPolicy::equal(value, new_value))
+            assign(new_value);
+    }
+
+    /**
+     * @brief Set the contained value by moving from the provided value. Notify observers of the change.
+     *
+     * Dispatches to set(const T&), such that overrides see every set operation. Passing the
+     * reference on to assign() moves from new_value instead of copying it. Overrides calling
+     * back into set(T&&) reach the implementation of this class, not themselves.
+     *
+     * @param [in] new_value The new value to move into this property. Left untouched if equal to the current value.
+     * @post get() == new_value;
+     */
+    inline void set(T&& new_value)
+    {
+        if (dispatching)
         {
-            value = new_value;
+            dispatching = false;
 
-            if (setter)
-                setter(value);
+            if (!EqualityPolicy::equal(value, new_value))
+                assign(std::move(new_value));
 
-            signal_changed(value);
+            return;
         }
+
+        struct Restore
+        {
+            ~Restore()
+            {
+                self.movable_value = previous;
+                self.dispatching = false;
+            }
+
+            Property& self;
+            T* previous;
+        } restore{*this, movable_value};
+
+        movable_value = &new_value;
+        dispatching = true;
+        set(static_cast<const T&>(new_value));
+    }
+
+    /**
+     * @brief Constructs a new value from the provided arguments and moves it into this property.
+     *
+     * The new value is compared to the current one and observers are notified on change, just
+     * like for set(). Apart from constructing the new value, no copies are made.
+     *
+     * @param args The arguments passed on to the constructor of T.
+     */
+    template<typename... Args>
+    inline void emplace(Args&&... args)
+    {
+        set(T(std::forward<Args>(args)...));
     }
 
     /**
@@ -157,8 +287,19 @@ class Property
     inline virtual const T& get() const
     {
         if (getter)
-            mutable_get() = getter();
-        
+        {
+            if (!cache.enabled)
+                mutable_get() = getter();
+            else if (cache.is_fresh())
+                cache.hits++;
+            else
+            {
+                cache.misses++;
+                mutable_get() = getter();
+                cache.refresh();
+            }
+        }
+
         return value;
     }
 
@@ -171,6 +312,24 @@ class Property
         return signal_changed;
     }
 
+#if defined(__cpp_impl_coroutine)
+    /**
+     * @brief Returns an awaitable that completes with the first changed value accepted by the predicate.
+     *
+     * Only subsequent changes are considered, not the current value. Awaiting does not allocate,
+     * see BasicSignal::NextEmission. Only available if the compiler supports C++20 coroutines.
+     *
+     * @param predicate Invoked with every new value until it returns true.
+     * @param dispatcher Resumes the awaiting coroutine, empty to resume it on the notifying thread.
+     */
+    template<typename Predicate>
+    inline auto changed_to(const Predicate& predicate,
+                           const Connection::Dispatcher& dispatcher = Connection::Dispatcher{}) const
+    {
+        return signal_changed.next_if(predicate, dispatcher);
+    }
+#endif
+
     /**
      * @brief Provides in-place update facilities.
      *
@@ -184,7 +343,7 @@ class Property
     {
         if (update_functor(mutable_get()))
         {
-            signal_changed(value);
+            notify_changed();
             return true;
         }
 
@@ -207,14 +366,48 @@ class Property
     inline void install(const Getter& getter)
     {
         this->getter = getter;
+        cache = GetterCache{};
+    }
+
+    /**
+     * @brief install takes the provided functor and installs it for dispatching get operations, caching its result.
+     *
+     * The result of the getter is reused by subsequent get operations until either the
+     * time-to-live elapsed or invalidate() is called, whatever happens first.
+     *
+     * @param getter The functor to be invoked for get operations.
+     * @param ttl The time-to-live of a cached result, until_invalidated() to only rely on invalidate().
+     */
+    inline void install(const Getter& getter, const Duration& ttl)
+    {
+        this->getter = getter;
+        cache = GetterCache{};
+        cache.enabled = true;
+        cache.ttl = ttl;
     }
 
-    friend inline const Property<T>& operator|(const Property<T>& lhs, Property<T>& rhs)
+    /**
+     * @brief Discards the cached getter result, the next get operation invokes the getter again.
+     */
+    inline void invalidate()
+    {
+        cache.valid = false;
+    }
+
+    /**
+     * @brief Queries the hit and miss counts of the cached getter installed for this property.
+     */
+    inline CacheStatistics cache_statistics() const
     {
-        rhs.connections.emplace(
+        return CacheStatistics{cache.hits, cache.misses};
+    }
+
+    friend inline const Property& operator|(const Property& lhs, Property& rhs)
+    {
+        rhs.connections.add(
                     lhs.changed().connect(
                         std::bind(
-                            &Property<T>::set,
+                            static_cast<void(Property::*)(const T&)>(&Property::set),
                             std::ref(rhs),
                             std::placeholders::_1)));
         return lhs;
@@ -226,12 +419,117 @@ class Property
         return value;
     }
 
+    /**
+     * @brief Stores the new value without comparing, dispatches it to the setter and notifies observers.
+     *
+     * Moves from new_value if it refers to the value handed to set(T&&).
+     */
+    inline void assign(const T& new_value)
+    {
+        dispatching = false;
+
+        if (&new_value == movable_value)
+        {
+            T* source = movable_value;
+            movable_value = nullptr;
+            value = std::move(*source);
+        } else
+        {
+            value = new_value;
+        }
+
+        dispatch_to_setter();
+        notify_changed();
+    }
+
+    /**
+     * @brief Moves the new value in without comparing, dispatches it to the setter and notifies observers.
+     */
+    inline void assign(T&& new_value)
+    {
+        dispatching = false;
+        value = std::move(new_value);
+
+        dispatch_to_setter();
+        notify_changed();
+    }
+
+    /**
+     * @brief Dispatches the stored value to the setter, if any.
+     *
+     * Subclasses modifying the value in place via mutable_get() call this before notifying
+     * observers, just like assign() does.
+     */
+    inline void dispatch_to_setter()
+    {
+        if (setter)
+            setter(value);
+    }
+
+    /**
+     * @brief Emits the changed signal, or defers it to the end of the active transaction.
+     */
+    inline void notify_changed()
+    {
+        if (!Transaction::is_active())
+        {
+            signal_changed(value);
+            return;
+        }
+
+        if (notification_pending)
+            return;
+
+        notification_pending = true;
+        Transaction::defer(this, [this]()
+        {
+            notification_pending = false;
+            signal_changed(value);
+        });
+    }
+
   private:
+    struct GetterCache
+    {
+        inline bool is_fresh() const
+        {
+            if (!valid)
+                return false;
+
+            if (ttl == until_invalidated())
+                return true;
+
+            return std::chrono::steady_clock::now() - fetched < ttl;
+        }
+
+        inline void refresh()
+        {
+            valid = true;
+
+            if (ttl != until_invalidated())
+                fetched = std::chrono::steady_clock::now();
+        }
+
+        bool enabled = false;
+        bool valid = false;
+        Duration ttl = until_invalidated();
+        std::chrono::steady_clock::time_point fetched;
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+    };
+
     mutable T value;
     Getter getter;
     Setter setter;
+    mutable GetterCache cache;
     Signal<T> signal_changed;
-    std::set<ScopedConnection> connections;
+    ConnectionGroup connections;
+    bool notification_pending;
+    // The argument of the set(T&&) call in progress, if any.
+    T* movable_value;
+    // Whether set(T&&) is dispatching to an override of set(const T&) that did not call
+    // back into this class yet.
+    bool dispatching;
 };
 }
 
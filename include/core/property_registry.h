@@ -0,0 +1,320 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_PROPERTY_REGISTRY_H_
+#define CORE_PROPERTY_REGISTRY_H_
+
+#include <core/property.h>
+#include <core/transaction.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace core
+{
+/**
+ * @brief Registers properties under stable keys, and dumps and restores their values as binary snapshots.
+ *
+ * A snapshot consists of a header followed by one record per property, each record
+ * carrying its key and the raw bytes of the value. The layout is compact and position
+ * independent: restoring maps the snapshot file into memory and decodes the records in
+ * place, without reading it into intermediate buffers. Properties are kept sorted by key
+ * and looked up right from the key bytes of a record, without allocating.
+ *
+ * Restoring happens within a core::Transaction, every property thus notifies its observers
+ * at most once, after all properties have been restored. Records with unknown keys or
+ * values of mismatching size are skipped.
+ *
+ * Supported value types are trivially copyable types and std::string. Snapshots are meant
+ * to be restored on the same platform they have been dumped on, values are stored in host
+ * byte order.
+ *
+ * A note on thread-safety: Just like Property, this class does not give any thread-safety guarantees.
+ * Registered properties have to outlive the registry or be removed before being destroyed.
+ */
+class PropertyRegistry
+{
+  public:
+    inline PropertyRegistry() = default;
+
+    PropertyRegistry(const PropertyRegistry&) = delete;
+    PropertyRegistry& operator=(const PropertyRegistry&) = delete;
+
+    /**
+     * @brief Registers a property holding a trivially copyable value under the given key.
+     * @return false iff the key is already taken.
+     */
+    template<typename T, typename EqualityPolicy>
+    inline bool add(const std::string& key, Property<T, EqualityPolicy>& property)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "PropertyRegistry requires trivially copyable values or std::string");
+
+        Entry entry;
+        entry.encode = [&property](std::string& out)
+        {
+            const T& value = property.get();
+            out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        };
+        entry.decode = [&property](const char* data, std::size_t size)
+        {
+            if (size != sizeof(T))
+                return false;
+
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            property.set(value);
+            return true;
+        };
+
+        return insert(key, std::move(entry));
+    }
+
+    /**
+     * @brief Registers a property holding a string under the given key.
+     * @return false iff the key is already taken.
+     */
+    template<typename EqualityPolicy>
+    inline bool add(const std::string& key, Property<std::string, EqualityPolicy>& property)
+    {
+        Entry entry;
+        entry.encode = [&property](std::string& out)
+        {
+            out.append(property.get());
+        };
+        entry.decode = [&property](const char* data, std::size_t size)
+        {
+            property.set(std::string(data, size));
+            return true;
+        };
+
+        return insert(key, std::move(entry));
+    }
+
+    /**
+     * @brief Unregisters the property known under the given key.
+     * @return true iff a property has been registered under the key.
+     */
+    inline bool remove(const std::string& key)
+    {
+        auto it = find(key.data(), key.size());
+        if (it == entries.end())
+            return false;
+
+        entries.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Queries the number of registered properties.
+     */
+    inline std::size_t size() const
+    {
+        return entries.size();
+    }
+
+    /**
+     * @brief Encodes the current values of all registered properties into a snapshot.
+     */
+    inline std::string snapshot() const
+    {
+        std::string result;
+        append(result, magic);
+        append(result, static_cast<std::uint32_t>(entries.size()));
+
+        std::string value;
+        for (const auto& entry : entries)
+        {
+            value.clear();
+            entry.second.encode(value);
+
+            append(result, static_cast<std::uint32_t>(entry.first.size()));
+            append(result, static_cast<std::uint32_t>(value.size()));
+            result.append(entry.first);
+            result.append(value);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Restores the values of all registered properties found in the given snapshot.
+     * @param data Points to the first byte of the snapshot.
+     * @param size The size of the snapshot in bytes.
+     * @return The number of properties restored, decoding stops at the first malformed record.
+     */
+    inline std::size_t restore(const char* data, std::size_t size)
+    {
+        std::uint32_t header[2];
+        if (size < sizeof(header))
+            return 0;
+
+        std::memcpy(header, data, sizeof(header));
+        if (header[0] != magic)
+            return 0;
+
+        std::size_t restored = 0;
+        std::size_t offset = sizeof(header);
+
+        Transaction transaction;
+        for (std::uint32_t i = 0; i < header[1]; i++)
+        {
+            std::uint32_t lengths[2];
+            if (size - offset < sizeof(lengths))
+                break;
+
+            std::memcpy(lengths, data + offset, sizeof(lengths));
+            offset += sizeof(lengths);
+
+            if (size - offset < std::size_t{lengths[0]} + lengths[1])
+                break;
+
+            auto it = find(data + offset, lengths[0]);
+            offset += lengths[0];
+
+            if (it != entries.end() && it->second.decode(data + offset, lengths[1]))
+                restored++;
+
+            offset += lengths[1];
+        }
+
+        transaction.commit();
+        return restored;
+    }
+
+    /**
+     * @brief Writes a snapshot of all registered properties to the file at path, replacing its contents.
+     * @return true iff the snapshot has been written completely.
+     */
+    inline bool dump(const std::string& path) const
+    {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (fd == -1)
+            return false;
+
+        auto buffer = snapshot();
+
+        std::size_t written = 0;
+        while (written < buffer.size())
+        {
+            auto result = ::write(fd, buffer.data() + written, buffer.size() - written);
+            if (result <= 0)
+                break;
+
+            written += static_cast<std::size_t>(result);
+        }
+
+        return ::close(fd) == 0 && written == buffer.size();
+    }
+
+    /**
+     * @brief Maps the snapshot file at path into memory and restores the registered properties from it.
+     * @return The number of properties restored, 0 if the file cannot be mapped.
+     */
+    inline std::size_t load(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            return 0;
+
+        struct stat status;
+        if (::fstat(fd, &status) == -1 || status.st_size == 0)
+        {
+            ::close(fd);
+            return 0;
+        }
+
+        auto size = static_cast<std::size_t>(status.st_size);
+        void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (address == MAP_FAILED)
+            return 0;
+
+        auto restored = restore(static_cast<const char*>(address), size);
+        ::munmap(address, size);
+
+        return restored;
+    }
+
+  private:
+    struct Entry
+    {
+        std::function<void(std::string&)> encode;
+        std::function<bool(const char*, std::size_t)> decode;
+    };
+
+    // "PCS1" in host byte order, identifies snapshots and their format version.
+    static constexpr std::uint32_t magic = 0x31534350;
+
+    typedef std::vector<std::pair<std::string, Entry>> Entries;
+
+    static inline void append(std::string& out, std::uint32_t value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // Finds the first entry whose key does not order before the given key bytes.
+    inline Entries::iterator lower_bound(const char* key, std::size_t size)
+    {
+        return std::lower_bound(
+                    entries.begin(),
+                    entries.end(),
+                    std::make_pair(key, size),
+                    [](const Entries::value_type& entry, const std::pair<const char*, std::size_t>& key)
+                    {
+                        return entry.first.compare(0, std::string::npos, key.first, key.second) < 0;
+                    });
+    }
+
+    // Finds the entry registered under the given key bytes, without allocating.
+    inline Entries::iterator find(const char* key, std::size_t size)
+    {
+        auto it = lower_bound(key, size);
+        if (it != entries.end() && it->first.compare(0, std::string::npos, key, size) == 0)
+            return it;
+
+        return entries.end();
+    }
+
+    inline bool insert(const std::string& key, Entry&& entry)
+    {
+        auto it = lower_bound(key.data(), key.size());
+        if (it != entries.end() && it->first == key)
+            return false;
+
+        entries.emplace(it, key, std::move(entry));
+        return true;
+    }
+
+    // Sorted by key.
+    Entries entries;
+};
+}
+
+#endif // CORE_PROPERTY_REGISTRY_H_
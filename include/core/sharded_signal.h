@@ -0,0 +1,223 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_SHARDED_SIGNAL_H_
+#define CORE_SHARDED_SIGNAL_H_
+
+#include <core/connection.h>
+#include <core/signal.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace core
+{
+namespace detail
+{
+// Bytes kept free around data that must not share a cache line with its neighbors.
+static constexpr std::size_t cache_line_size = 64;
+
+// Selects the shard for the calling thread: the CPU it runs on if known, a per-thread choice otherwise.
+inline std::size_t current_shard(std::size_t shard_count)
+{
+#if defined(__linux__)
+    int cpu = ::sched_getcpu();
+    if (cpu >= 0)
+        return static_cast<std::size_t>(cpu) % shard_count;
+#endif
+    static thread_local std::size_t shard = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return shard % shard_count;
+}
+}
+
+/**
+ * @brief A signal replicated into one shard per CPU, for very high emission rates from many threads.
+ *
+ * Every shard is a complete signal with its own slot list snapshot, reference count and
+ * emission bookkeeping, separated from the other shards by cache line padding. Emitting
+ * only touches the shard of the CPU the emitting thread runs on, such that concurrent
+ * emissions on different CPUs do not contend for any cache line. Connecting and
+ * disconnecting pay for this by updating all shards.
+ *
+ * Connections returned by this class refer to all replicas of their slot at once and
+ * support disconnecting and installing dispatchers just like connections of a Signal.
+ *
+ * Shards are assigned to CPUs round-robin by CPU number. Without a portable way to place
+ * memory on NUMA nodes, replicas live wherever the connecting thread allocated them.
+ *
+ * @tparam Arguments List of argument types passed on to observers when the signal is emitted.
+ */
+template<typename ...Arguments>
+class ShardedSignal
+{
+public:
+    /**
+     * @brief Slot is the function type that observers have to provide to connect to this signal.
+     */
+    typedef typename Signal<Arguments...>::Slot Slot;
+
+    /**
+     * @brief ShardedSignal constructs a new instance.
+     * @param shard_count The number of replicas, one per hardware thread by default.
+     */
+    inline explicit ShardedSignal(std::size_t shard_count = std::thread::hardware_concurrency())
+        : d(std::make_shared<Private>(shard_count > 0 ? shard_count : 1))
+    {
+    }
+
+    ShardedSignal(const ShardedSignal&) = delete;
+    ShardedSignal& operator=(const ShardedSignal&) = delete;
+    bool operator==(const ShardedSignal&) const = delete;
+
+    /**
+     * @brief Queries the number of shards.
+     */
+    inline std::size_t shard_count() const
+    {
+        return d->shards.size();
+    }
+
+    /**
+     * @brief Connects the provided slot to all shards of this signal.
+     * @param slot The function to be called when the signal is emitted.
+     * @param priority Slots of higher priority are invoked first.
+     * @return A connection object corresponding to all replicas of the signal-slot connection.
+     */
+    inline Connection connect(const Slot& slot, int priority = 0) const
+    {
+        return d->connect(d, slot, priority);
+    }
+
+    /**
+     * @brief operator () emits the signal on the shard of the calling thread.
+     *
+     * The same considerations as for Signal::operator() apply.
+     *
+     * @param args The arguments to be passed on to registered slots.
+     */
+    inline void operator()(const Arguments&... args)
+    {
+        auto& shard = *d->shards[detail::current_shard(d->shards.size())];
+
+        shard.emissions.fetch_add(1, std::memory_order_relaxed);
+        shard.signal(args...);
+    }
+
+    /**
+     * @brief Sums up the number of emissions across all shards.
+     *
+     * Emissions in progress on other threads might or might not be accounted for.
+     */
+    inline std::uint64_t emission_count() const
+    {
+        std::uint64_t result = 0;
+        for (const auto& shard : d->shards)
+            result += shard->emissions.load(std::memory_order_relaxed);
+
+        return result;
+    }
+
+private:
+    struct Shard
+    {
+        char leading_padding[detail::cache_line_size];
+        Signal<Arguments...> signal;
+        std::atomic<std::uint64_t> emissions{0};
+        char trailing_padding[detail::cache_line_size];
+    };
+
+    // Tracks the replicas making up every connection, connections refer to this instance.
+    struct Private : public detail::ConnectionTarget
+    {
+        inline explicit Private(std::size_t shard_count)
+        {
+            shards.reserve(shard_count);
+            for (std::size_t i = 0; i < shard_count; i++)
+                shards.emplace_back(new Shard());
+        }
+
+        inline Connection connect(const std::shared_ptr<Private>& self, const Slot& slot, int priority)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+
+            std::uint32_t index = generations.acquire();
+            std::uint32_t generation = generations.entry(index).load(std::memory_order_relaxed);
+
+            if (replicas.size() <= index)
+                replicas.resize(index + 1);
+
+            replicas[index].clear();
+            for (const auto& shard : shards)
+                replicas[index].push_back(shard->signal.connect(slot, priority));
+
+            return Connection{self, index, generation};
+        }
+
+        inline void install_dispatcher(std::uint32_t index,
+                                       std::uint32_t generation,
+                                       const Connection::Dispatcher& dispatcher) override
+        {
+            std::lock_guard<std::mutex> lg(guard);
+
+            if (!generations.is_current(index, generation))
+                return;
+
+            for (auto& replica : replicas[index])
+                replica.dispatch_via(dispatcher);
+        }
+
+        inline void slots_retired(const std::uint32_t* indices, std::size_t count) override
+        {
+            std::vector<Connection> retired;
+            {
+                std::lock_guard<std::mutex> lg(guard);
+
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    auto& replica = replicas[indices[i]];
+                    retired.insert(retired.end(), replica.begin(), replica.end());
+                    replica.clear();
+
+                    generations.release(indices[i]);
+                }
+            }
+
+            for (auto& connection : retired)
+                connection.disconnect();
+        }
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        // Serializes connecting and disconnecting, never taken for emissions.
+        std::mutex guard;
+        std::vector<std::vector<Connection>> replicas;
+    };
+
+    std::shared_ptr<Private> d;
+};
+}
+
+#endif // CORE_SHARDED_SIGNAL_H_
@@ -0,0 +1,419 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_SHARED_MEMORY_PROPERTY_H_
+#define CORE_SHARED_MEMORY_PROPERTY_H_
+
+#include <core/signal.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace core
+{
+/**
+ * @brief A property replicated across processes on the same host via a named shared memory segment.
+ *
+ * All instances opened with the same name, in any process, refer to the same value. The value
+ * lives in the shared segment and is guarded by a sequence lock: readers never block writers
+ * and never serialize anything, they copy the raw bytes and retry if a write interfered.
+ * Writers serialize among each other on the sequence counter, and wake up remote instances
+ * by means of a futex on the very same counter.
+ *
+ * Every instance runs a watcher thread that emits the changed signal for values written by
+ * other instances. For values written by this instance, the changed signal is emitted on the
+ * writing thread instead. Changes arriving in quick succession might be coalesced into a single
+ * notification carrying the latest value.
+ *
+ * The segment persists until it is removed via remove(). A process terminating in the middle of
+ * a write leaves the segment locked: get() and set() detect a write that makes no progress for
+ * longer than the write timeout passed on construction and fail with EOWNERDEAD. The segment
+ * cannot be used anymore, and has to be removed and created anew.
+ *
+ * This class is only available on Linux.
+ *
+ * @tparam T The type of the value, has to be trivially copyable and must not contain pointers
+ * as these are meaningless in other processes.
+ */
+template<typename T>
+class SharedMemoryProperty
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SharedMemoryProperty requires a trivially copyable type");
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "SharedMemoryProperty requires atomics usable as futex words");
+
+  public:
+    /**
+     * @brief ValueType refers to the type of the contained value.
+     */
+    typedef T ValueType;
+
+    /**
+     * @brief SharedMemoryProperty opens the named segment, creating and initializing it if it does not exist yet.
+     * @param name The name of the segment, of the form "/some-name", see shm_open(3).
+     * @param t The initial value, ignored if the segment exists already.
+     * @param write_timeout The time a write may block readers and other writers, and the time
+     * the creator of the segment may take to initialize it, before either is considered dead.
+     * @throw std::system_error if the segment cannot be created, opened or mapped, was created
+     * for another type, or has not been initialized by its creator within write_timeout (ETIMEDOUT).
+     */
+    inline explicit SharedMemoryProperty(const std::string& name,
+                                         const T& t = T{},
+                                         const std::chrono::milliseconds& write_timeout = std::chrono::seconds{1})
+        : segment{nullptr},
+          write_timeout{write_timeout},
+          observed{0},
+          stopped{false}
+    {
+        bool created = true;
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd == -1 && errno == EEXIST)
+        {
+            created = false;
+            fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+        }
+
+        if (fd == -1)
+            throw std::system_error(errno, std::system_category(), "shm_open");
+
+        if (created && ::ftruncate(fd, sizeof(Segment)) == -1)
+            fail(fd, "ftruncate");
+
+        // The creator might not have sized the segment yet, or might have died before doing so.
+        auto deadline = std::chrono::steady_clock::now() + write_timeout;
+
+        struct stat status;
+        for (;;)
+        {
+            if (::fstat(fd, &status) == -1)
+                fail(fd, "fstat");
+
+            if (status.st_size != 0)
+                break;
+
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                ::close(fd);
+                throw std::system_error(ETIMEDOUT, std::system_category(), "segment has not been sized by its creator");
+            }
+
+            std::this_thread::yield();
+        }
+
+        if (static_cast<std::size_t>(status.st_size) != sizeof(Segment))
+        {
+            ::close(fd);
+            throw std::system_error(EINVAL, std::system_category(), "segment holds a value of different type");
+        }
+
+        void* address = ::mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED)
+            fail(fd, "mmap");
+
+        ::close(fd);
+        segment = static_cast<Segment*>(address);
+
+        if (created)
+        {
+            segment->size = sizeof(T);
+            std::memcpy(&segment->value, &t, sizeof(T));
+            segment->initialized.store(1, std::memory_order_release);
+        } else
+        {
+            while (segment->initialized.load(std::memory_order_acquire) == 0)
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    ::munmap(segment, sizeof(Segment));
+                    throw std::system_error(ETIMEDOUT, std::system_category(), "segment has not been initialized by its creator");
+                }
+
+                std::this_thread::yield();
+            }
+
+            if (segment->size != sizeof(T))
+            {
+                ::munmap(segment, sizeof(Segment));
+                throw std::system_error(EINVAL, std::system_category(), "segment holds a value of different type");
+            }
+        }
+
+        observed.store(segment->sequence.load(std::memory_order_acquire), std::memory_order_relaxed);
+        watcher = std::thread{&SharedMemoryProperty::watch, this};
+    }
+
+    SharedMemoryProperty(const SharedMemoryProperty&) = delete;
+    SharedMemoryProperty& operator=(const SharedMemoryProperty&) = delete;
+
+    /**
+     * @brief Stops the watcher thread and unmaps the segment, which stays in place for other instances.
+     */
+    inline ~SharedMemoryProperty()
+    {
+        stopped.store(true);
+        wake();
+        watcher.join();
+
+        ::munmap(segment, sizeof(Segment));
+    }
+
+    /**
+     * @brief Removes the named segment, instances already opened continue to work on it.
+     * @return true iff the segment existed and has been removed.
+     */
+    static inline bool remove(const std::string& name)
+    {
+        return ::shm_unlink(name.c_str()) == 0;
+    }
+
+    /**
+     * @brief Assignment operator, only assigns to the contained value.
+     * @param rhs The right-hand-side, raw value to assign to this property.
+     */
+    inline SharedMemoryProperty& operator=(const T& rhs)
+    {
+        set(rhs);
+        return *this;
+    }
+
+    /**
+     * @brief Explicit casting operator to the contained value type.
+     * @return A copy of the contained value.
+     */
+    inline operator T() const
+    {
+        return get();
+    }
+
+    /**
+     * @brief Access the value contained within the shared segment. Thread- and process-safe, never blocks writers.
+     * @return A consistent copy of the value.
+     * @throw std::system_error if a writer terminated in the middle of a write (EOWNERDEAD).
+     */
+    inline T get() const
+    {
+        T result;
+        Stall stall;
+
+        for (;;)
+        {
+            std::uint32_t begin = segment->sequence.load(std::memory_order_acquire);
+            if (begin & 1)
+            {
+                stall.wait(begin, write_timeout);
+                continue;
+            }
+
+            std::memcpy(&result, &segment->value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (segment->sequence.load(std::memory_order_relaxed) == begin)
+                return result;
+        }
+    }
+
+    /**
+     * @brief Set the shared value to the provided value. Notify all instances of the change. Thread- and process-safe.
+     * @param [in] new_value The new value to assign to this property.
+     * @return true iff the shared value has been changed by this call.
+     * @throw std::system_error if a writer terminated in the middle of a write (EOWNERDEAD).
+     */
+    inline bool set(const T& new_value)
+    {
+        std::uint32_t begin = lock();
+
+        T current;
+        std::memcpy(&current, &segment->value, sizeof(T));
+
+        if (current == new_value)
+        {
+            // Nothing has been written, readers that started before locking stay valid.
+            // Watchers waiting on the odd sequence return from the futex by themselves.
+            segment->sequence.store(begin, std::memory_order_release);
+            return false;
+        }
+
+        std::memcpy(&segment->value, &new_value, sizeof(T));
+
+        observed.store(begin + 2, std::memory_order_relaxed);
+        segment->sequence.store(begin + 2, std::memory_order_release);
+        wake();
+
+        signal_changed(new_value);
+        return true;
+    }
+
+    /**
+     * @brief Access to the changed signal, allows observers to subscribe to change notifications.
+     * @return A non-mutable reference to the changed signal.
+     */
+    inline const Signal<T>& changed() const
+    {
+        return signal_changed;
+    }
+
+  private:
+    struct Segment
+    {
+        std::atomic<std::uint32_t> initialized;
+        // Odd while a write is in progress, doubles as futex word.
+        std::atomic<std::uint32_t> sequence;
+        std::uint32_t size;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
+    };
+
+    // Tracks a write in progress that readers or writers wait for to complete.
+    struct Stall
+    {
+        // Yields to the writer, throws if sequence did not change for longer than timeout.
+        inline void wait(std::uint32_t sequence, const std::chrono::milliseconds& timeout)
+        {
+            auto now = std::chrono::steady_clock::now();
+
+            if (!stalled || sequence != this->sequence)
+            {
+                stalled = true;
+                this->sequence = sequence;
+                since = now;
+            } else if (now - since > timeout)
+            {
+                throw std::system_error(EOWNERDEAD, std::system_category(), "writer terminated in the middle of a write");
+            }
+
+            std::this_thread::yield();
+        }
+
+        bool stalled = false;
+        std::uint32_t sequence = 0;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    inline static void fail(int fd, const char* what)
+    {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::system_category(), what);
+    }
+
+    // Acquires the write lock by making the sequence odd, returns the preceding even sequence.
+    inline std::uint32_t lock()
+    {
+        std::uint32_t begin = segment->sequence.load(std::memory_order_relaxed);
+        Stall stall;
+
+        for (;;)
+        {
+            if (begin & 1)
+            {
+                stall.wait(begin, write_timeout);
+                begin = segment->sequence.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (segment->sequence.compare_exchange_weak(begin, begin + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                break;
+        }
+
+        std::atomic_thread_fence(std::memory_order_release);
+        return begin;
+    }
+
+    inline void wake()
+    {
+        ::syscall(SYS_futex, futex_word(), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    inline std::uint32_t* futex_word()
+    {
+        return reinterpret_cast<std::uint32_t*>(&segment->sequence);
+    }
+
+    inline void watch()
+    {
+        // Bounds the time a missed wake-up on destruction might delay joining the watcher.
+        static const timespec timeout{0, 50 * 1000 * 1000};
+
+        // Starts off with the sequence seen on opening, to not miss writes before the thread got scheduled.
+        std::uint32_t seen = observed.load();
+
+        while (!stopped.load())
+        {
+            ::syscall(SYS_futex, futex_word(), FUTEX_WAIT, seen, &timeout, nullptr, 0);
+
+            std::uint32_t current = segment->sequence.load(std::memory_order_acquire);
+            if (current == seen)
+                continue;
+
+            seen = current;
+
+            // Writes in progress wake us once more on completion.
+            if ((current & 1) || !advance_observed(current))
+                continue;
+
+            T value;
+            try
+            {
+                value = get();
+            } catch(const std::system_error&)
+            {
+                // A writer died in the middle of a write, there is nothing left to emit.
+                continue;
+            }
+
+            signal_changed(value);
+        }
+    }
+
+    // Advances observed to current unless local observers know about current or a newer
+    // sequence already, e.g. because this instance wrote it. Aware of wrap-around.
+    inline bool advance_observed(std::uint32_t current)
+    {
+        std::uint32_t last = observed.load();
+
+        while (static_cast<std::int32_t>(current - last) > 0)
+            if (observed.compare_exchange_weak(last, current))
+                return true;
+
+        return false;
+    }
+
+    Segment* segment;
+    std::chrono::milliseconds write_timeout;
+    // The sequence of the latest value local observers have been notified about.
+    std::atomic<std::uint32_t> observed;
+    std::atomic<bool> stopped;
+    Signal<T> signal_changed;
+    std::thread watcher;
+};
+}
+
+#endif // CORE_SHARED_MEMORY_PROPERTY_H_
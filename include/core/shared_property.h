@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_SHARED_PROPERTY_H_
+#define CORE_SHARED_PROPERTY_H_
+
+#include <core/detail/atomic_shared_ptr.h>
+#include <core/signal.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace core
+{
+/**
+ * @brief A thread-safe property that publishes immutable snapshots of its value.
+ *
+ * Readers obtain a shared_ptr to the current snapshot and keep using it for as long as they
+ * like. Writers are serialized among each other, build the new value aside and publish it
+ * with a single pointer swap. This suits values that are too large for AtomicProperty and
+ * read far more often than written.
+ *
+ * Readers never wait for writers unless PROPERTIES_CPP_HAS_ATOMIC_SHARED_PTR is set, see
+ * core/config.h: std::atomic<std::shared_ptr> as implemented by libstdc++ and libc++ lets
+ * readers spin while a writer swaps the pointer. Writers in turn wait for the readers that
+ * are copying the replaced pointer, in either configuration.
+ *
+ * The changed signal is emitted on the writing thread after the new snapshot has been published.
+ *
+ * @tparam T The type of the value contained within the property.
+ */
+template<typename T>
+class SharedProperty
+{
+  public:
+    /**
+     * @brief ValueType refers to the type of the contained value.
+     */
+    typedef T ValueType;
+
+    /**
+     * @brief Snapshot refers to an immutable version of the contained value.
+     */
+    typedef std::shared_ptr<const T> Snapshot;
+
+    /**
+     * @brief SharedProperty creates a new instance and initializes the contained value.
+     * @param t The initial value.
+     */
+    inline explicit SharedProperty(const T& t = T{}) : value{std::make_shared<const T>(t)}
+    {
+    }
+
+    /**
+     * @brief SharedProperty creates a new instance and moves the initial value into it.
+     * @param t The initial value.
+     */
+    inline explicit SharedProperty(T&& t) : value{std::make_shared<const T>(std::move(t))}
+    {
+    }
+
+    SharedProperty(const SharedProperty&) = delete;
+    SharedProperty& operator=(const SharedProperty&) = delete;
+
+    /**
+     * @brief Assignment operator, only assigns to the contained value.
+     * @param rhs The right-hand-side, raw value to assign to this property.
+     */
+    inline SharedProperty& operator=(const T& rhs)
+    {
+        set(rhs);
+        return *this;
+    }
+
+    /**
+     * @brief Access the current snapshot of the contained value. Thread-safe, see above for whether it waits for writers.
+     * @return The current snapshot, which stays valid and unchanged for as long as it is referenced.
+     */
+    inline Snapshot get() const
+    {
+        return value.load();
+    }
+
+    /**
+     * @brief Set the contained value to the provided value. Notify observers of the change. Thread-safe.
+     * @param [in] new_value The new value to assign to this property.
+     * @return true iff the contained value has been changed by this call.
+     */
+    inline bool set(const T& new_value)
+    {
+        Snapshot snapshot;
+        {
+            std::lock_guard<std::mutex> lg(writer_guard);
+
+            // Compares against the current snapshot in place, the new value is copied once.
+            if (*value.load() == new_value)
+                return false;
+
+            snapshot = std::make_shared<const T>(new_value);
+            value.store(snapshot);
+        }
+
+        signal_changed(*snapshot);
+        return true;
+    }
+
+    /**
+     * @brief Applies the update functor to a copy of the contained value and publishes the result. Thread-safe.
+     *
+     * If the update functor returns true, indicating that the value has been changed,
+     * the updated copy becomes the current snapshot and the changed signal is emitted.
+     *
+     * @param update_functor The update function to be applied to the contained value.
+     * @return true iff application of the update functor has been successful.
+     */
+    inline bool update(const std::function<bool(T& t)>& update_functor)
+    {
+        Snapshot snapshot;
+        {
+            std::lock_guard<std::mutex> lg(writer_guard);
+
+            T updated(*value.load());
+            if (!update_functor(updated))
+                return false;
+
+            snapshot = std::make_shared<const T>(std::move(updated));
+            value.store(snapshot);
+        }
+
+        signal_changed(*snapshot);
+        return true;
+    }
+
+    /**
+     * @brief Access to the changed signal, allows observers to subscribe to change notifications.
+     * @return A non-mutable reference to the changed signal.
+     */
+    inline const Signal<T>& changed() const
+    {
+        return signal_changed;
+    }
+
+  private:
+    // Serializes writers, never taken by readers.
+    std::mutex writer_guard;
+    detail::AtomicSharedPtr<const T> value;
+    Signal<T> signal_changed;
+};
+}
+
+#endif // CORE_SHARED_PROPERTY_H_
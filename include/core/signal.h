@@ -19,278 +19,743 @@
 #define COM_UBUNTU_SIGNAL_H_
 
 #include <core/connection.h>
+#include <core/detail/atomic_shared_ptr.h>
+#include <core/detail/handler_queue.h>
+#include <core/detail/index_sequence.h>
+#include <core/detail/signal_state.h>
 
+#include <atomic>
 #include <functional>
 #include <iostream>
-#include <list>
+#include <memory>
 #include <mutex>
 #include <set>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <optional>
+#endif
 
 namespace core
 {
+#if defined(__cpp_impl_coroutine)
+namespace detail
+{
+// The result of awaiting an emission: nothing, the single argument or a tuple of all arguments.
+template<typename... Arguments>
+struct EmissionResult
+{
+    typedef std::tuple<std::decay_t<Arguments>...> Type;
+};
+
+template<typename Argument>
+struct EmissionResult<Argument>
+{
+    typedef std::decay_t<Argument> Type;
+};
+
+template<>
+struct EmissionResult<>
+{
+    typedef void Type;
+};
+}
+#endif
+
+namespace detail
+{
+template<typename T>
+struct Void
+{
+    typedef void Type;
+};
+
+// Placeholder filter key of signals without arguments.
+struct NoKey
+{
+};
+
+// The filter key of a signal is its decayed first argument.
+template<typename... Arguments>
+struct FilterKey
+{
+    typedef NoKey Type;
+};
+
+template<typename First, typename... Rest>
+struct FilterKey<First, Rest...>
+{
+    typedef typename std::decay<First>::type Type;
+};
+
+// Selects the allocator a slot policy asks for via a nested Allocator template, std::allocator otherwise.
+template<typename SlotPolicy, typename T, typename = void>
+struct SlotAllocator
+{
+    typedef std::allocator<T> Type;
+};
+
+template<typename SlotPolicy, typename T>
+struct SlotAllocator<SlotPolicy, T, typename Void<typename SlotPolicy::template Allocator<T>>::Type>
+{
+    typedef typename SlotPolicy::template Allocator<T> Type;
+};
+}
+
 /**
- * @brief A signal class that observers can subscribe to.
+ * @brief Slot policy that stores slots as type-erased std::function instances.
+ *
+ * Slot policies might provide a nested, stateless Allocator template for the memory
+ * backing the slot list snapshots of a signal, see PooledSlots.
+ */
+struct DynamicSlots
+{
+    template<typename Signature>
+    using Slot = std::function<Signature>;
+};
+
+/**
+ * @brief The signal implementation shared by all signal variants.
+ * @tparam SlotPolicy Determines how slots are stored, see DynamicSlots.
  * @tparam Arguments List of argument types passed on to observers when the signal is emitted.
  */
-template<typename ...Arguments>
-class Signal
+template<typename SlotPolicy, typename ...Arguments>
+class BasicSignal
 {
 public:
     /**
      * @brief Slot is the function type that observers have to provide to connect to this signal.
      */
-    typedef std::function<void(Arguments...)> Slot;
+    typedef typename SlotPolicy::template Slot<void(Arguments...)> Slot;
+
+    /**
+     * @brief Key refers to the type slots can filter emissions by, the decayed first argument.
+     */
+    typedef typename detail::FilterKey<Arguments...>::Type Key;
 
 private:
+    // A queued invocation of a slot, carrying a copy of the emitted arguments. Refers to the
+    // slot within the snapshot it is stored in, which the invocation keeps alive.
+    struct Invocation
+    {
+        inline void operator()() const
+        {
+            invoke(typename detail::MakeIndexSequence<sizeof...(Arguments)>::Type{});
+        }
+
+        template<std::size_t... Indices>
+        inline void invoke(detail::IndexSequence<Indices...>) const
+        {
+            (*slot)(std::get<Indices>(arguments)...);
+        }
+
+        std::shared_ptr<const Slot> slot;
+        std::tuple<typename std::decay<Arguments>::type...> arguments;
+    };
+
     struct SlotWrapper
     {
-        void operator()(Arguments... args)
+        // Slots without an installed dispatcher are invoked immediately, by reference
+        // and without allocating. Only queueing dispatchers installed via
+        // Connection::dispatch_via receive a closure, which copies the arguments
+        // exactly once, and not at all for signals without arguments. The closure
+        // shares ownership of snapshot, the slot list this wrapper is stored in,
+        // instead of copying the slot.
+        template<typename Snapshot>
+        inline void operator()(const Snapshot& snapshot, const Arguments&... args) const
         {
-            dispatcher(std::bind(slot, args...));
+            auto timer = probe.time(); (void) timer;
+
+            if (dispatcher)
+                queue(std::shared_ptr<const Slot>{snapshot, &slot}, args...);
+            else
+                slot(args...);
+        }
+
+        // Handler queues receive the invocation itself, see detail::HandlerQueue.
+        inline void queue(std::shared_ptr<const Slot> queued, const Arguments&... args) const
+        {
+            Invocation invocation{std::move(queued), std::tuple<typename std::decay<Arguments>::type...>{args...}};
+
+            if (auto adaptor = dispatcher.template target<detail::HandlerQueue::Adaptor>())
+                adaptor->queue->enqueue(&invocation, detail::HandlerOperationsFor<Invocation>::table);
+            else
+                dispatcher(std::move(invocation));
         }
 
         Slot slot;
         Connection::Dispatcher dispatcher;
-        Connection connection;
+        detail::SlotHandle handle;
+        detail::SlotProbe probe;
+        int priority;
+        // The object a slot connected via connect(std::weak_ptr<Obj>, ...) calls into.
+        std::weak_ptr<const void> target;
+        bool tracks_target;
+    };
+
+    typedef detail::SignalState<
+        SlotWrapper,
+        typename detail::SlotAllocator<SlotPolicy, SlotWrapper>::Type
+    > Private;
+
+    // Looks up the slots connected for the filter key of an emission.
+    struct Router
+    {
+        virtual ~Router() = default;
+        virtual std::shared_ptr<Private> route(const Arguments&... args) const = 0;
+    };
+
+    // Keeps one slot list per filter key, indexed by a copy-on-write hash map.
+    struct KeyedSlots : public Router
+    {
+        typedef std::unordered_map<Key, std::shared_ptr<Private>> Index;
+
+        // The slot lists of all keys report to the instrumentation statistics of parent.
+        inline explicit KeyedSlots(const detail::SignalProbe& parent)
+            : parent(parent),
+              index(std::make_shared<const Index>())
+        {
+        }
+
+        template<typename First, typename... Rest>
+        static inline const First& first(const First& first, const Rest&...)
+        {
+            return first;
+        }
+
+        inline std::shared_ptr<Private> route(const Arguments&... args) const override
+        {
+            auto current = index.load();
+
+            auto it = current->find(first(args...));
+            if (it == current->end())
+                return std::shared_ptr<Private>{};
+
+            return it->second;
+        }
+
+        // Returns the slot list for key, creating it if necessary.
+        inline std::shared_ptr<Private> state_for(const Key& key)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+
+            auto current = index.load();
+
+            auto it = current->find(key);
+            if (it != current->end())
+                return it->second;
+
+            auto state = std::make_shared<Private>(parent, current->size() + 1);
+
+            auto updated = std::make_shared<Index>(*current);
+            updated->emplace(key, state);
+            index.store(updated);
+
+            return state;
+        }
+
+        const detail::SignalProbe& parent;
+        // Serializes insertions of keys, never taken for emissions.
+        std::mutex guard;
+        detail::AtomicSharedPtr<const Index> index;
     };
 
 public:
     /**
-     * @brief Signal constructs a new instance. Never throws.
+     * @brief BasicSignal constructs a new instance. Never throws.
      */
-    inline Signal() noexcept(true) : d(new Private())
+    inline BasicSignal() noexcept(true) : d(new Private(std::string{})), router(nullptr)
     {
     }
 
-    inline ~Signal()
+    /**
+     * @brief BasicSignal constructs a new, named instance.
+     *
+     * The name identifies the signal in the statistics exposed by instrumentation::Registry
+     * if PROPERTIES_CPP_ENABLE_INSTRUMENTATION is enabled, and is ignored otherwise.
+     *
+     * @param name The name of the signal.
+     */
+    inline explicit BasicSignal(const std::string& name) : d(new Private(name)), router(nullptr)
     {
-        std::lock_guard<std::mutex> lg(d->guard);
-        for (auto slot : d->slot_list)
-            slot.connection.reset();
+    }
+
+    inline ~BasicSignal()
+    {
+        // Connections refer to the shared state weakly and turn
+        // into no-ops once it is gone.
+        d->probe.retire();
+        delete router.load();
     }
 
     // Copy construction, assignment and equality comparison are disabled.
-    Signal(const Signal&) = delete;
-    Signal& operator=(const Signal&) = delete;
-    bool operator==(const Signal&) const = delete;
+    BasicSignal(const BasicSignal&) = delete;
+    BasicSignal& operator=(const BasicSignal&) = delete;
+    bool operator==(const BasicSignal&) const = delete;
 
     /**
      * @brief Connects the provided slot to this signal instance.
      *
      * Calling this method is thread-safe and synchronized with any
-     * other connect, signal emission or disconnect calls.
+     * other connect or disconnect calls. The slot is added to a new
+     * snapshot of the slot list, such that emissions already in progress
+     * are not affected and do not block the call.
      *
      * @param slot The function to be called when the signal is emitted.
      * @return A connection object corresponding to the signal-slot connection.
      */
     inline Connection connect(const Slot& slot) const
     {
-        // Helpers to initialize an invalid connection.
-        static const Connection::Disconnector empty_disconnector{};
-        static const Connection::DispatcherInstaller empty_dispatcher_installer{};
-
-        // The default dispatcher immediately executes the function object
-        // provided as argument on whatever thread is currently running.
-        static const Connection::Dispatcher default_dispatcher
-                = [](const std::function<void()>& handler) { handler(); };
-
-        Connection conn{empty_disconnector, empty_dispatcher_installer};
-
-        std::lock_guard<std::mutex> lg(d->guard);
-
-        auto result = d->slot_list.insert(
-                    d->slot_list.end(),
-                    SlotWrapper{slot, default_dispatcher, conn});
-
-        // We implicitly share our internal state with the connection here
-        // by passing in our private bits contained in 'd' to the std::bind call.
-        // This admittedly uncommon approach allows us to cleanly manage connection
-        // and signal lifetimes without the need to mark everything as mutable.
-        conn.d->disconnector = std::bind(
-                    &Private::disconnect_slot_for_iterator,
-                    d,
-                    result);
-        conn.d->dispatcher_installer = std::bind(
-                    &Private::install_dispatcher_for_iterator,
-                    d,
-                    std::placeholders::_1,
-                    result);
-
-        return conn;
+        // An empty dispatcher results in the slot being executed immediately
+        // on whatever thread is currently emitting the signal.
+        return connect(slot, 0);
     }
 
     /**
-     * @brief operator () emits the signal with the provided parameters.
+     * @brief Connects the provided slot to this signal instance with the given priority.
      *
-     * Please note that signal emissions might not be delivered immediately to
-     * registered slots, depending on whether the respective connection is dispatched
-     * via a queueing dispatcher. For that reason, the lifetime of the arguments has to
-     * exceed the scope of the call to this operator and its surrounding scope.
+     * Slots are invoked in the order of descending priority, slots of equal priority in the
+     * order they have been connected in. Slots connected without priority have priority 0.
      *
-     * @param args The arguments to be passed on to registered slots.
+     * @param slot The function to be called when the signal is emitted.
+     * @param priority Slots of higher priority are invoked first.
+     * @return A connection object corresponding to the signal-slot connection.
      */
-    inline void operator()(Arguments... args)
+    inline Connection connect(const Slot& slot, int priority) const
     {
-        std::lock_guard<std::mutex> lg(d->guard);
-        for(auto slot : d->slot_list)
-        {
-            slot(args...);
-        }
+        return add(d, slot, priority);
     }
 
-private:
-    struct Private
+    /**
+     * @brief Connects the given member function of a weakly referenced object to this signal instance.
+     *
+     * The connection ends by itself once the object has been destroyed: emissions skip
+     * slots whose object expired and disconnect them, such that they are pruned from the
+     * slot list once the emission has finished. There is no need to keep the returned
+     * connection around.
+     *
+     * @param target The object to invoke the member function on, referenced weakly.
+     * @param method The member function, invocable with the arguments of this signal.
+     * @param priority Slots of higher priority are invoked first.
+     * @return A connection object corresponding to the signal-slot connection.
+     */
+    template<typename Obj, typename Method>
+    inline Connection connect(const std::weak_ptr<Obj>& target, Method method, int priority = 0) const
     {
-        typedef std::list<SlotWrapper> SlotList;
+        return add(d,
+                   [target, method](const Arguments&... args)
+                   {
+                       if (auto locked = target.lock())
+                           ((*locked).*method)(args...);
+                   },
+                   priority,
+                   target,
+                   true);
+    }
 
-        inline void disconnect_slot_for_iterator(typename SlotList::iterator it)
-        {
-            std::lock_guard<std::mutex> lg(guard);
-            slot_list.erase(it);
-        }
+    /**
+     * @brief Connects the given member function of an object to this signal instance, referencing the object weakly.
+     *
+     * Equivalent to connecting via a std::weak_ptr to target, see above.
+     */
+    template<typename Obj, typename Method>
+    inline Connection connect(const std::shared_ptr<Obj>& target, Method method, int priority = 0) const
+    {
+        return connect(std::weak_ptr<Obj>{target}, method, priority);
+    }
 
-        inline void install_dispatcher_for_iterator(const Connection::Dispatcher& dispatcher,
-                                                    typename SlotList::iterator it)
-        {
-            std::lock_guard<std::mutex> lg(guard);
-            it->dispatcher = dispatcher;
-        }
+    /**
+     * @brief Connects the provided slot to emissions whose first argument equals key.
+     *
+     * Slots connected this way are kept in a hash index by key. An emission looks up the
+     * slots for its first argument once, and never invokes slots connected for other keys,
+     * however many there are. The matching slots are invoked interleaved with all unfiltered
+     * slots by priority, before unfiltered slots of equal priority.
+     *
+     * Only available for signals with at least one argument, whose decayed type has to be
+     * hashable by std::hash and equality comparable.
+     *
+     * @param key The value of the first argument the slot is interested in.
+     * @param slot The function to be called when the signal is emitted with key.
+     * @param priority Slots of higher priority are invoked first.
+     * @return A connection object corresponding to the signal-slot connection.
+     */
+    inline Connection connect_keyed(const Key& key, const Slot& slot, int priority = 0) const
+    {
+        static_assert(sizeof...(Arguments) > 0, "Filter keys are only available for signals with arguments");
 
-        std::mutex guard;
-        SlotList slot_list;
-    };
-    std::shared_ptr<Private> d;
-};
+        return add(keyed_slots().state_for(key), slot, priority);
+    }
 
-/**
- * @brief A signal class that observers can subscribe to,
- * template specialization for signals without arguments.
- */
-template<>
-class Signal<void>
-{
-public:
     /**
-     * @brief Slot is the function type that observers have to provide to connect to this signal.
+     * @brief Connects all provided slots to this signal instance at once.
+     *
+     * Equivalent to calling connect() for every slot, but takes the guard
+     * and rewrites the slot list only once.
+     *
+     * @param slots The functions to be called when the signal is emitted.
+     * @return The connection objects corresponding to the slots, in order.
      */
-    typedef std::function<void()> Slot;
+    inline std::vector<Connection> connect_many(const std::vector<Slot>& slots) const
+    {
+        std::vector<SlotWrapper> wrappers;
+        wrappers.reserve(slots.size());
+        for (const auto& slot : slots)
+            wrappers.push_back(SlotWrapper
+            {
+                slot,
+                Connection::Dispatcher{},
+                detail::SlotHandle{},
+                detail::SlotProbe{},
+                0,
+                std::weak_ptr<const void>{},
+                false
+            });
+
+        d->add(wrappers.data(), wrappers.data() + wrappers.size());
+
+        std::vector<Connection> connections;
+        connections.reserve(wrappers.size());
+        for (const auto& wrapper : wrappers)
+            connections.push_back(Connection{d, wrapper.handle.index, wrapper.handle.generation});
+
+        return connections;
+    }
 
+#if defined(__cpp_impl_coroutine)
 private:
-    struct SlotWrapper
+    // The part of a waiter the emitting thread talks to.
+    struct Waiter : detail::WaiterNode
     {
-        void operator()()
+        // Returns false if the emission has been rejected and the waiter keeps waiting.
+        bool (*offer)(Waiter* waiter, const Arguments&... args);
+    };
+
+    struct AnyEmission
+    {
+        inline bool operator()(const Arguments&...) const
         {
-            dispatcher(slot);
+            return true;
         }
-
-        Slot slot;
-        Connection::Dispatcher dispatcher;
-        Connection connection;
     };
 
 public:
     /**
-     * @brief Signal constructs a new instance. Never throws.
+     * @brief An awaitable that completes with the arguments of the next accepted emission.
+     *
+     * The awaitable is its own waiter node: awaiting it links it into the signal without
+     * allocating, and no thread blocks while waiting. The awaiting coroutine is resumed on
+     * the emitting thread, or via the dispatcher passed to next() or next_if().
+     *
+     * Destroying a suspended coroutine unregisters its waiter, but must not race with an
+     * emission of the signal.
+     *
+     * @tparam Predicate Decides whether an emission completes the wait.
      */
-    inline Signal() noexcept(true) : d(new Private())
+    template<typename Predicate>
+    class NextEmission : private Waiter
     {
-    }
+    public:
+        /**
+         * @brief Result refers to the type of a co_await expression on this awaitable.
+         */
+        typedef typename detail::EmissionResult<Arguments...>::Type Result;
+
+        inline NextEmission(NextEmission&& rhs) = default;
+
+        inline ~NextEmission()
+        {
+            if (d)
+                d->remove(this);
+        }
+
+        NextEmission(const NextEmission&) = delete;
+        NextEmission& operator=(const NextEmission&) = delete;
+
+        inline bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        inline void await_suspend(std::coroutine_handle<> handle)
+        {
+            this->handle = handle;
+            d->enqueue(this);
+        }
+
+        inline Result await_resume()
+        {
+            if constexpr (sizeof...(Arguments) == 1)
+                return std::move(std::get<0>(*arguments));
+            else if constexpr (sizeof...(Arguments) > 1)
+                return std::move(*arguments);
+        }
+
+    private:
+        friend class BasicSignal;
 
-    inline ~Signal()
+        inline NextEmission(const std::shared_ptr<Private>& d,
+                            const Predicate& predicate,
+                            const Connection::Dispatcher& dispatcher)
+            : d(d),
+              predicate(predicate),
+              dispatcher(dispatcher)
+        {
+            this->offer = &NextEmission::offer_emission;
+        }
+
+        // The node is not touched anymore once the coroutine has been handed off for resumption.
+        static inline bool offer_emission(Waiter* waiter, const Arguments&... args)
+        {
+            auto self = static_cast<NextEmission*>(waiter);
+
+            if (!self->predicate(args...))
+                return false;
+
+            self->arguments.emplace(args...);
+
+            auto handle = self->handle;
+            if (self->dispatcher)
+                self->dispatcher([handle]() { handle.resume(); });
+            else
+                handle.resume();
+
+            return true;
+        }
+
+        std::shared_ptr<Private> d;
+        Predicate predicate;
+        Connection::Dispatcher dispatcher;
+        std::coroutine_handle<> handle;
+        std::optional<std::tuple<std::decay_t<Arguments>...>> arguments;
+    };
+
+    /**
+     * @brief Returns an awaitable that completes with the next emission of this signal.
+     *
+     * Only available if the compiler supports C++20 coroutines.
+     *
+     * @param dispatcher Resumes the awaiting coroutine, empty to resume it on the emitting thread.
+     */
+    inline NextEmission<AnyEmission> next(const Connection::Dispatcher& dispatcher = Connection::Dispatcher{}) const
     {
-        std::lock_guard<std::mutex> lg(d->guard);
-        for (auto slot : d->slot_list)
-            slot.connection.reset();
+        return NextEmission<AnyEmission>{d, AnyEmission{}, dispatcher};
     }
 
-    // Copy construction, assignment and equality comparison are disabled.
-    Signal(const Signal&) = delete;
-    Signal& operator=(const Signal&) = delete;
-    bool operator==(const Signal&) const = delete;
-
     /**
-     * @brief Connects the provided slot to this signal instance.
+     * @brief Returns an awaitable that completes with the next emission accepted by the predicate.
      *
-     * Calling this method is thread-safe and synchronized with any
-     * other connect, signal emission or disconnect calls.
+     * Only available if the compiler supports C++20 coroutines.
      *
-     * @param slot The function to be called when the signal is emitted.
-     * @return A connection object corresponding to the signal-slot connection.
+     * @param predicate Invoked with the arguments of every emission until it returns true.
+     * @param dispatcher Resumes the awaiting coroutine, empty to resume it on the emitting thread.
      */
-    inline Connection connect(const Slot& slot) const
+    template<typename Predicate>
+    inline NextEmission<Predicate> next_if(const Predicate& predicate,
+                                           const Connection::Dispatcher& dispatcher = Connection::Dispatcher{}) const
     {
-        // Helpers to initialize an invalid connection.
-        static const Connection::Disconnector empty_disconnector{};
-        static const Connection::DispatcherInstaller empty_dispatcher_installer{};
-
-        // The default dispatcher immediately executes the function object
-        // provided as argument on whatever thread is currently running.
-        static const Connection::Dispatcher default_dispatcher
-                = [](const std::function<void()>& handler) { handler(); };
-
-        Connection conn{empty_disconnector, empty_dispatcher_installer};
-
-        std::lock_guard<std::mutex> lg(d->guard);
-
-        auto result = d->slot_list.insert(
-                    d->slot_list.end(),
-                    SlotWrapper{slot, default_dispatcher, conn});
-
-        // We implicitly share our internal state with the connection here
-        // by passing in our private bits contained in 'd' to the std::bind call.
-        // This admittedly uncommon approach allows us to cleanly manage connection
-        // and signal lifetimes without the need to mark everything as mutable.
-        conn.d->disconnector = std::bind(
-                    &Private::disconnect_slot_for_iterator,
-                    d,
-                    result);
-        conn.d->dispatcher_installer = std::bind(
-                    &Private::install_dispatcher_for_iterator,
-                    d,
-                    std::placeholders::_1,
-                    result);
-
-        return conn;
+        return NextEmission<Predicate>{d, predicate, dispatcher};
     }
+#endif
 
     /**
-     * @brief operator () emits the signal.
+     * @brief operator () emits the signal with the provided parameters.
      *
      * Please note that signal emissions might not be delivered immediately to
      * registered slots, depending on whether the respective connection is dispatched
-     * via a queueing dispatcher.
+     * via a queueing dispatcher. For that reason, the lifetime of the arguments has to
+     * exceed the scope of the call to this operator and its surrounding scope.
+     *
+     * Emission does not hold any lock while invoking slots: the slots are taken from an
+     * immutable snapshot of the slot list. Concurrent emissions thus do not serialize,
+     * and slots are free to connect to or disconnect from the emitting signal. A slot
+     * that is disconnected is skipped by all emissions that did not invoke it yet, but
+     * might still be executing on another thread when disconnect() returns.
+     *
+     * Emitting a signal that never had any slots connected only costs a few atomic loads.
+     *
+     * @param args The arguments to be passed on to registered slots.
      */
-    inline void operator()()
+    inline void operator()(const Arguments&... args)
     {
-        std::lock_guard<std::mutex> lg(d->guard);
-        for(auto slot : d->slot_list)
+        d->probe.emitted();
+
+        Router* r = router.load(std::memory_order_acquire);
+        if (r || d->has_slots())
+            invoke_slots(r, args...);
+
+#if defined(__cpp_impl_coroutine)
+        detail::WaiterNode* node = d->take_waiters();
+        while (node)
         {
-            slot();
+            auto waiter = static_cast<Waiter*>(node);
+            node = node->next;
+
+            if (!waiter->offer(waiter, args...))
+                d->enqueue(waiter);
         }
+#endif
     }
 
 private:
-    struct Private
+    inline void invoke_slots(Router* r, const Arguments&... args)
     {
-        typedef std::list<SlotWrapper> SlotList;
+        typename Private::EmissionScope scope{*d};
+
+        auto slots = d->snapshot();
+        std::shared_ptr<Private> routed = r ? r->route(args...) : std::shared_ptr<Private>{};
 
-        inline void disconnect_slot_for_iterator(typename SlotList::iterator it)
+        if (!routed)
         {
-            std::lock_guard<std::mutex> lg(guard);
-            slot_list.erase(it);
+            for(const auto& slot : *slots)
+                invoke(*d, slots, slot, args...);
+        } else
+        {
+            typename Private::EmissionScope routed_scope{*routed};
+            invoke_merged(slots, *routed, args...);
         }
+    }
 
-        inline void install_dispatcher_for_iterator(const Connection::Dispatcher& dispatcher,
-                                                    typename SlotList::iterator it)
+    inline static Connection add(const std::shared_ptr<Private>& state, const Slot& slot, int priority)
+    {
+        return add(state, slot, priority, std::weak_ptr<const void>{}, false);
+    }
+
+    inline static Connection add(const std::shared_ptr<Private>& state,
+                                 const Slot& slot,
+                                 int priority,
+                                 const std::weak_ptr<const void>& target,
+                                 bool tracks_target)
+    {
+        // An empty dispatcher results in the slot being executed immediately
+        // on whatever thread is currently emitting the signal.
+        SlotWrapper wrapper
         {
-            std::lock_guard<std::mutex> lg(guard);
-            it->dispatcher = dispatcher;
+            slot,
+            Connection::Dispatcher{},
+            detail::SlotHandle{},
+            detail::SlotProbe{},
+            priority,
+            target,
+            tracks_target
+        };
+        state->add(&wrapper, &wrapper + 1);
+
+        return Connection{state, wrapper.handle.index, wrapper.handle.generation};
+    }
+
+    // Installs the index of keyed slots on first use.
+    inline KeyedSlots& keyed_slots() const
+    {
+        Router* current = router.load(std::memory_order_acquire);
+        if (current)
+            return static_cast<KeyedSlots&>(*current);
+
+        Router* created = new KeyedSlots(d->probe);
+        if (!router.compare_exchange_strong(current, created, std::memory_order_acq_rel))
+        {
+            delete created;
+            return static_cast<KeyedSlots&>(*current);
         }
 
-        std::mutex guard;
-        SlotList slot_list;
-    };
+        return static_cast<KeyedSlots&>(*created);
+    }
+
+    // Invokes a connected slot of snapshot, unless the object it calls into expired, which
+    // disconnects it.
+    static inline void invoke(Private& state,
+                              const std::shared_ptr<const typename Private::SlotList>& snapshot,
+                              const SlotWrapper& slot,
+                              const Arguments&... args)
+    {
+        if (!slot.handle.is_alive())
+            return;
+
+        if (slot.tracks_target && slot.target.expired())
+        {
+            state.disconnect(slot.handle.index, slot.handle.generation);
+            return;
+        }
+
+        slot(snapshot, args...);
+    }
+
+    // Invokes the slots of the snapshot of this signal and of the routed slot list,
+    // both ordered by priority, as one ordered sequence.
+    inline void invoke_merged(const std::shared_ptr<const typename Private::SlotList>& slots,
+                              Private& routed,
+                              const Arguments&... args)
+    {
+        auto routed_slots = routed.snapshot();
+
+        auto it = slots->begin();
+        auto routed_it = routed_slots->begin();
+
+        while (it != slots->end() || routed_it != routed_slots->end())
+        {
+            if (routed_it != routed_slots->end() && (it == slots->end() || routed_it->priority >= it->priority))
+                invoke(routed, routed_slots, *routed_it++, args...);
+            else
+                invoke(*d, slots, *it++, args...);
+        }
+    }
+
     std::shared_ptr<Private> d;
+    // Only created once a slot connects for a filter key, owned by this instance.
+    mutable std::atomic<Router*> router;
+};
+
+/**
+ * @brief A signal class that observers can subscribe to.
+ * @tparam Arguments List of argument types passed on to observers when the signal is emitted.
+ */
+template<typename ...Arguments>
+class Signal : public BasicSignal<DynamicSlots, Arguments...>
+{
+public:
+    /**
+     * @brief Signal constructs a new instance. Never throws.
+     */
+    inline Signal() noexcept(true)
+    {
+    }
+
+    /**
+     * @brief Signal constructs a new, named instance, see BasicSignal.
+     * @param name The name of the signal.
+     */
+    inline explicit Signal(const std::string& name) : BasicSignal<DynamicSlots, Arguments...>(name)
+    {
+    }
+};
+
+/**
+ * @brief A signal class that observers can subscribe to,
+ * template specialization for signals without arguments.
+ */
+template<>
+class Signal<void> : public BasicSignal<DynamicSlots>
+{
+public:
+    /**
+     * @brief Signal constructs a new instance. Never throws.
+     */
+    inline Signal() noexcept(true)
+    {
+    }
+
+    /**
+     * @brief Signal constructs a new, named instance, see BasicSignal.
+     * @param name The name of the signal.
+     */
+    inline explicit Signal(const std::string& name) : BasicSignal<DynamicSlots>(name)
+    {
+    }
 };
 }
 
@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_STATIC_SIGNAL_H_
+#define CORE_STATIC_SIGNAL_H_
+
+#include <core/inline_function.h>
+#include <core/signal.h>
+
+namespace core
+{
+/**
+ * @brief Slot policy that stores slots inline, without type erasure on the heap.
+ * @tparam Capacity The inline buffer size available to each slot, in bytes.
+ */
+template<std::size_t Capacity>
+struct InlineSlots
+{
+    template<typename Signature>
+    using Slot = InlineFunction<Signature, Capacity>;
+};
+
+/**
+ * @brief A signal class whose slots never allocate.
+ *
+ * Slots are stored in a fixed-size inline buffer of Capacity bytes. Connecting a
+ * callable that exceeds this buffer fails to compile instead of falling back to the heap.
+ *
+ * @tparam Capacity The inline buffer size available to each slot, in bytes.
+ * @tparam Arguments List of argument types passed on to observers when the signal is emitted.
+ */
+template<std::size_t Capacity, typename ...Arguments>
+class StaticSignal : public BasicSignal<InlineSlots<Capacity>, Arguments...>
+{
+public:
+    /**
+     * @brief StaticSignal constructs a new instance. Never throws.
+     */
+    inline StaticSignal() noexcept(true)
+    {
+    }
+
+    /**
+     * @brief StaticSignal constructs a new, named instance, see BasicSignal.
+     * @param name The name of the signal.
+     */
+    inline explicit StaticSignal(const std::string& name) : BasicSignal<InlineSlots<Capacity>, Arguments...>(name)
+    {
+    }
+};
+}
+
+#endif // CORE_STATIC_SIGNAL_H_
@@ -0,0 +1,274 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_THREAD_POOL_DISPATCHER_H_
+#define CORE_THREAD_POOL_DISPATCHER_H_
+
+#include <core/connection.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+/**
+ * @brief A dispatcher that fans handlers out to a pool of work-stealing worker threads.
+ *
+ * Every worker owns a queue of handlers. Handlers dispatched from a worker thread are
+ * queued locally, all other handlers are distributed round-robin. Idle workers steal
+ * handlers from the queues of their peers. Connecting the slots of a signal via the
+ * adaptor returned by dispatcher() thus executes them in parallel.
+ *
+ * Exceptions thrown by handlers are swallowed.
+ */
+class ThreadPoolDispatcher
+{
+public:
+    /**
+     * @brief Handler refers to the function type executed by the workers.
+     */
+    typedef std::function<void()> Handler;
+
+    /**
+     * @brief ThreadPoolDispatcher creates a new instance and starts its workers.
+     * @param worker_count The number of worker threads, defaults to the number of cores.
+     */
+    inline explicit ThreadPoolDispatcher(std::size_t worker_count = std::thread::hardware_concurrency())
+        : next_queue(0),
+          queued_count(0),
+          pending_count(0),
+          idle_count(0),
+          stop_requested(false)
+    {
+        if (worker_count == 0)
+            worker_count = 1;
+
+        for (std::size_t i = 0; i < worker_count; i++)
+            queues.emplace_back(new Queue());
+
+        for (std::size_t i = 0; i < worker_count; i++)
+            workers.emplace_back([this, i]() { work(i); });
+    }
+
+    /**
+     * @brief Executes all pending handlers and stops the workers.
+     */
+    inline ~ThreadPoolDispatcher()
+    {
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            stop_requested = true;
+            work_available.notify_all();
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    ThreadPoolDispatcher(const ThreadPoolDispatcher&) = delete;
+    ThreadPoolDispatcher& operator=(const ThreadPoolDispatcher&) = delete;
+
+    /**
+     * @brief Queries the number of worker threads.
+     */
+    inline std::size_t worker_count() const
+    {
+        return workers.size();
+    }
+
+    /**
+     * @brief Queues a handler for execution on one of the workers. Thread-safe.
+     * @param handler The handler to be executed.
+     */
+    inline void dispatch(const Handler& handler)
+    {
+        pending_count++;
+
+        std::size_t index = current_worker().first == this
+                ? current_worker().second
+                : next_queue++ % queues.size();
+
+        {
+            std::lock_guard<std::mutex> lg(queues[index]->guard);
+            queues[index]->handlers.push_back(handler);
+            queued_count++;
+        }
+
+        if (idle_count.load() > 0)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            work_available.notify_one();
+        }
+    }
+
+    /**
+     * @brief Returns an adaptor suitable for Connection::dispatch_via.
+     *
+     * The adaptor refers to this instance, which has to outlive all connections using it.
+     */
+    inline Connection::Dispatcher dispatcher()
+    {
+        return [this](const Handler& handler) { dispatch(handler); };
+    }
+
+    /**
+     * @brief Blocks until all handlers dispatched so far have been executed.
+     *
+     * The calling thread helps executing pending handlers while waiting. Must not be
+     * called from within a handler executed by this instance.
+     */
+    inline void wait()
+    {
+        while (pending_count.load() > 0)
+        {
+            Handler handler;
+            if (steal(queues.size(), handler))
+            {
+                execute(handler);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> ul(guard);
+            all_done.wait_for(
+                        ul,
+                        std::chrono::milliseconds{1},
+                        [this]() { return pending_count.load() == 0; });
+        }
+    }
+
+    /**
+     * @brief Emits a signal and waits for the invocations of all slots dispatched via this instance.
+     * @param signal The signal to emit.
+     * @param args The arguments passed on to the slots.
+     */
+    template<typename Signal, typename... Args>
+    inline void emit_and_wait(Signal& signal, const Args&... args)
+    {
+        signal(args...);
+        wait();
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex guard;
+        std::deque<Handler> handlers;
+    };
+
+    // The pool and worker index the calling thread belongs to, if any.
+    static inline std::pair<const ThreadPoolDispatcher*, std::size_t>& current_worker()
+    {
+        static thread_local std::pair<const ThreadPoolDispatcher*, std::size_t> instance{nullptr, 0};
+        return instance;
+    }
+
+    // Owners take the most recently queued handler from their own queue.
+    inline bool pop(std::size_t index, Handler& handler)
+    {
+        std::lock_guard<std::mutex> lg(queues[index]->guard);
+        if (queues[index]->handlers.empty())
+            return false;
+
+        handler = std::move(queues[index]->handlers.back());
+        queues[index]->handlers.pop_back();
+        queued_count--;
+        return true;
+    }
+
+    // Thieves take the oldest handler from any queue but their own.
+    inline bool steal(std::size_t thief, Handler& handler)
+    {
+        for (std::size_t i = 0; i < queues.size(); i++)
+        {
+            if (i == thief)
+                continue;
+
+            std::lock_guard<std::mutex> lg(queues[i]->guard);
+            if (queues[i]->handlers.empty())
+                continue;
+
+            handler = std::move(queues[i]->handlers.front());
+            queues[i]->handlers.pop_front();
+            queued_count--;
+            return true;
+        }
+
+        return false;
+    }
+
+    inline void execute(const Handler& handler)
+    {
+        try
+        {
+            handler();
+        } catch(...)
+        {
+        }
+
+        if (--pending_count == 0)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            all_done.notify_all();
+        }
+    }
+
+    inline void work(std::size_t index)
+    {
+        current_worker() = std::make_pair(this, index);
+
+        for (;;)
+        {
+            Handler handler;
+            if (pop(index, handler) || steal(index, handler))
+            {
+                execute(handler);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> ul(guard);
+            idle_count++;
+            work_available.wait(ul, [this]() { return stop_requested || queued_count.load() > 0; });
+            idle_count--;
+
+            if (stop_requested && queued_count.load() == 0)
+                return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> next_queue;
+    std::atomic<std::size_t> queued_count;
+    std::atomic<std::size_t> pending_count;
+    std::atomic<std::size_t> idle_count;
+    bool stop_requested;
+    std::mutex guard;
+    std::condition_variable work_available;
+    std::condition_variable all_done;
+};
+}
+
+#endif // CORE_THREAD_POOL_DISPATCHER_H_
@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+#ifndef CORE_TRANSACTION_H_
+#define CORE_TRANSACTION_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+/**
+ * @brief RAII scope that coalesces change notifications of properties.
+ *
+ * While a transaction is active on the calling thread, properties record their changes
+ * instead of emitting their changed signal. When the outermost transaction commits, every
+ * modified property emits its changed signal exactly once, with its final value. Transactions
+ * nest, only the outermost one delivers the pending notifications.
+ *
+ * A note on thread-safety: Transactions are tracked per thread and only affect properties
+ * modified on the thread that opened the transaction.
+ */
+class Transaction
+{
+public:
+    /**
+     * @brief Notifier refers to the function type that delivers a pending notification.
+     */
+    typedef std::function<void()> Notifier;
+
+    /**
+     * @brief Opens a new, potentially nested transaction on the calling thread.
+     */
+    inline Transaction() : committed(false)
+    {
+        state().depth++;
+    }
+
+    /**
+     * @brief Commits the transaction if that has not happened before.
+     *
+     * Exceptions thrown by observers are swallowed, call commit() explicitly to observe them.
+     */
+    inline ~Transaction() noexcept(true)
+    {
+        try
+        {
+            commit();
+        } catch(...)
+        {
+        }
+    }
+
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    /**
+     * @brief Ends this transaction, delivering all pending notifications if it is the outermost one.
+     *
+     * All pending notifications are delivered even if observers throw, the first exception
+     * is rethrown once delivery has finished. Calling commit() more than once has no effect.
+     */
+    inline void commit()
+    {
+        if (committed)
+            return;
+
+        committed = true;
+
+        State& s = state();
+        if (--s.depth > 0 || s.delivering)
+            return;
+
+        // Observers might modify properties again, those changes are not part
+        // of this transaction anymore and are notified immediately. Notifications
+        // recorded by transactions that observers open are appended to the batch and
+        // delivered by this loop. Entries are taken out one by one, such that cancel()
+        // still reaches the ones that have not been delivered yet.
+        s.delivering = true;
+        std::exception_ptr error;
+
+        for (std::size_t i = 0; i < s.pending.size(); i++)
+        {
+            Notifier notifier;
+            notifier.swap(s.pending[i].second);
+
+            if (!notifier)
+                continue;
+
+            try
+            {
+                notifier();
+            } catch(...)
+            {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+
+        s.pending.clear();
+        s.delivering = false;
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    /**
+     * @brief Checks if a transaction is active on the calling thread.
+     */
+    static inline bool is_active()
+    {
+        return state().depth > 0;
+    }
+
+    /**
+     * @brief Records a change notification to be delivered when the outermost transaction commits.
+     * @param key Identifies the originator of the notification, e.g., the modified property.
+     * @param notifier The function delivering the notification.
+     */
+    static inline void defer(const void* key, const Notifier& notifier)
+    {
+        state().pending.push_back(Pending{key, notifier});
+    }
+
+    /**
+     * @brief Discards all pending notifications recorded for the given key.
+     * @param key Identifies the originator of the notifications.
+     */
+    static inline void cancel(const void* key)
+    {
+        State& s = state();
+        auto& pending = s.pending;
+
+        // The batch being delivered must not be reordered, see commit().
+        if (s.delivering)
+        {
+            for (auto& p : pending)
+                if (p.first == key)
+                    p.second = nullptr;
+
+            return;
+        }
+
+        pending.erase(
+                    std::remove_if(
+                        pending.begin(),
+                        pending.end(),
+                        [key](const Pending& p) { return p.first == key; }),
+                    pending.end());
+    }
+
+private:
+    typedef std::pair<const void*, Notifier> Pending;
+
+    struct State
+    {
+        std::size_t depth = 0;
+        bool delivering = false;
+        std::vector<Pending> pending;
+    };
+
+    static inline State& state()
+    {
+        static thread_local State instance;
+        return instance;
+    }
+
+    bool committed;
+};
+}
+
+#endif // CORE_TRANSACTION_H_
@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/atomic_property.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct Point
+{
+    bool operator==(const Point& rhs) const
+    {
+        return x == rhs.x && y == rhs.y;
+    }
+
+    int x;
+    int y;
+};
+}
+
+TEST(AtomicProperty, default_construction_yields_default_value)
+{
+    core::AtomicProperty<int> p;
+    EXPECT_EQ(0, p.get());
+}
+
+TEST(AtomicProperty, set_emits_changed_only_on_a_real_change)
+{
+    core::AtomicProperty<Point> p{Point{1, 2}};
+
+    unsigned int notification_count = 0;
+    Point last{0, 0};
+    p.changed().connect([&](const Point& point) { notification_count++; last = point; });
+
+    EXPECT_FALSE(p.set(Point{1, 2}));
+    EXPECT_EQ(0u, notification_count);
+
+    EXPECT_TRUE(p.set(Point{3, 4}));
+    EXPECT_EQ(1u, notification_count);
+    EXPECT_EQ((Point{3, 4}), last);
+    EXPECT_EQ((Point{3, 4}), p.get());
+}
+
+TEST(AtomicProperty, update_is_only_applied_if_the_functor_succeeds)
+{
+    core::AtomicProperty<int> p{41};
+
+    unsigned int notification_count = 0;
+    p.changed().connect([&notification_count](int) { notification_count++; });
+
+    EXPECT_FALSE(p.update([](int& i) { i = 0; return false; }));
+    EXPECT_EQ(41, p.get());
+    EXPECT_EQ(0u, notification_count);
+
+    EXPECT_TRUE(p.update([](int& i) { i++; return true; }));
+    EXPECT_EQ(42, p.get());
+    EXPECT_EQ(1u, notification_count);
+}
+
+TEST(AtomicProperty, concurrent_updates_are_not_lost)
+{
+    static const unsigned int thread_count = 4;
+    static const unsigned int updates_per_thread = 10000;
+
+    core::AtomicProperty<unsigned int> p{0};
+
+    std::atomic<unsigned int> notification_count{0};
+    p.changed().connect([&notification_count](unsigned int) { notification_count++; });
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < thread_count; i++)
+        threads.emplace_back([&p]()
+        {
+            for (unsigned int j = 0; j < updates_per_thread; j++)
+                p.update([](unsigned int& value) { value++; return true; });
+        });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(thread_count * updates_per_thread, p.get());
+    EXPECT_EQ(thread_count * updates_per_thread, notification_count.load());
+}
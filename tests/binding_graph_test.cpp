@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/binding_graph.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+TEST(BindingGraph, bound_properties_follow_their_source)
+{
+    core::BindingGraph graph;
+    core::Property<int> source{1};
+    core::Property<int> target;
+    core::Property<std::string> converted;
+
+    EXPECT_TRUE(graph.bind(source, target));
+    EXPECT_TRUE(graph.bind(target, converted, [](int i) { return std::to_string(i); }));
+
+    source.set(42);
+    EXPECT_EQ(42, target.get());
+    EXPECT_EQ("42", converted.get());
+}
+
+TEST(BindingGraph, diamonds_update_every_node_exactly_once)
+{
+    core::BindingGraph graph;
+    core::Property<int> a{0};
+    core::Property<int> b;
+    core::Property<int> c;
+    core::Property<int> d;
+
+    graph.bind(a, b, [](int i) { return i + 1; });
+    graph.bind(a, c, [](int i) { return i * 2; });
+
+    unsigned int computations = 0;
+    graph.compute(d, [&computations](int b, int c) { computations++; return b + c; }, b, c);
+
+    std::vector<int> observed;
+    d.changed().connect([&observed](int i) { observed.push_back(i); });
+
+    a.set(1);
+    EXPECT_EQ(1u, computations);
+    EXPECT_EQ(std::vector<int>{4}, observed);
+}
+
+TEST(BindingGraph, unchanged_nodes_do_not_trigger_their_outputs)
+{
+    core::BindingGraph graph;
+    core::Property<int> a{0};
+    core::Property<bool> positive;
+    core::Property<int> d;
+
+    unsigned int computations = 0;
+    graph.bind(a, positive, [](int i) { return i > 0; });
+    graph.compute(d, [&computations](bool p) { computations++; return p ? 1 : -1; }, positive);
+
+    a.set(1);
+    a.set(2);
+    EXPECT_EQ(1u, computations);
+    EXPECT_EQ(1, d.get());
+}
+
+TEST(BindingGraph, deep_chains_propagate_iteratively)
+{
+    static const std::size_t depth = 10000;
+
+    core::BindingGraph graph;
+    std::vector<core::Property<int>> chain(depth);
+
+    for (std::size_t i = 1; i < depth; i++)
+        graph.bind(chain[i - 1], chain[i]);
+
+    chain.front().set(42);
+    EXPECT_EQ(42, chain.back().get());
+}
+
+TEST(BindingGraph, cycles_and_second_bindings_are_rejected)
+{
+    core::BindingGraph graph;
+    core::Property<int> a;
+    core::Property<int> b;
+    core::Property<int> c;
+
+    EXPECT_TRUE(graph.bind(a, b));
+    EXPECT_TRUE(graph.bind(b, c));
+    EXPECT_FALSE(graph.bind(c, a));
+    EXPECT_FALSE(graph.bind(a, a));
+    EXPECT_FALSE(graph.bind(a, c));
+    EXPECT_EQ(3u, graph.size());
+}
+
+TEST(BindingGraph, computed_properties_can_act_as_sources)
+{
+    core::BindingGraph graph;
+    core::Property<int> a{1};
+    core::ComputedProperty<int> squared{[&a]() { return a.get() * a.get(); }, a};
+    core::Property<int> target;
+
+    graph.compute(target, [](int a, int squared) { return a + squared; }, a, squared);
+
+    a.set(3);
+    EXPECT_EQ(12, target.get());
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/coalescing_dispatcher.h>
+#include <core/event_loop_dispatcher.h>
+#include <core/property.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST(CoalescingDispatcher, coalesce_keeps_at_most_one_invocation_queued_per_connection)
+{
+    core::EventLoopDispatcher loop{16};
+    core::Property<int> p{0};
+
+    std::vector<int> values;
+    auto connection = p.changed().connect([&values](int value) { values.push_back(value); });
+    connection.dispatch_via(core::coalesce(loop.dispatcher()));
+
+    for (int i = 1; i <= 100; i++)
+        p.set(i);
+
+    EXPECT_EQ(1u, loop.run_once());
+    EXPECT_EQ((std::vector<int>{100}), values);
+
+    p.set(101);
+    EXPECT_EQ(1u, loop.run_once());
+    EXPECT_EQ((std::vector<int>{100, 101}), values);
+}
+
+TEST(CoalescingDispatcher, flush_delivers_the_latest_value_of_every_connection)
+{
+    core::CoalescingDispatcher dispatcher;
+    core::Property<int> p1{0}, p2{0};
+
+    int last1 = 0, last2 = 0;
+    auto c1 = p1.changed().connect([&last1](int value) { last1 = value; });
+    auto c2 = p2.changed().connect([&last2](int value) { last2 = value; });
+    c1.dispatch_via(dispatcher.dispatcher());
+    c2.dispatch_via(dispatcher.dispatcher());
+
+    EXPECT_EQ(0u, dispatcher.flush());
+
+    for (int i = 1; i <= 10; i++)
+    {
+        p1.set(i);
+        p2.set(-i);
+    }
+
+    EXPECT_EQ(2u, dispatcher.pending());
+    EXPECT_EQ(0, last1);
+
+    EXPECT_EQ(2u, dispatcher.flush());
+    EXPECT_EQ(10, last1);
+    EXPECT_EQ(-10, last2);
+    EXPECT_EQ(0u, dispatcher.pending());
+}
+
+TEST(CoalescingDispatcher, a_minimum_interval_limits_the_delivery_rate)
+{
+    core::CoalescingDispatcher dispatcher{std::chrono::milliseconds{50}};
+    core::Property<int> p{0};
+
+    std::vector<int> values;
+    auto connection = p.changed().connect([&values](int value) { values.push_back(value); });
+    connection.dispatch_via(dispatcher.dispatcher());
+
+    p.set(1);
+    EXPECT_EQ(1u, dispatcher.flush());
+
+    p.set(2);
+    p.set(3);
+    EXPECT_EQ(0u, dispatcher.flush());
+    EXPECT_EQ(1u, dispatcher.pending());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{60});
+    EXPECT_EQ(1u, dispatcher.flush());
+    EXPECT_EQ((std::vector<int>{1, 3}), values);
+}
+
+TEST(CoalescingDispatcher, pending_slots_are_released_together_with_their_adaptor)
+{
+    core::CoalescingDispatcher dispatcher;
+
+    auto token = std::make_shared<int>(42);
+    {
+        auto adaptor = dispatcher.dispatcher();
+        adaptor([token]() {});
+
+        EXPECT_EQ(1u, dispatcher.pending());
+        EXPECT_EQ(2, token.use_count());
+    }
+
+    EXPECT_EQ(1, token.use_count());
+    EXPECT_EQ(0u, dispatcher.pending());
+    EXPECT_EQ(0u, dispatcher.flush());
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/collection_property.h>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+TEST(CollectionProperty, vector_mutators_emit_deltas_and_changed)
+{
+    core::CollectionProperty<std::vector<int>> p;
+
+    std::vector<core::CollectionDelta<std::size_t, int>> deltas;
+    std::size_t changes = 0;
+    p.delta().connect([&deltas](const core::CollectionDelta<std::size_t, int>& d) { deltas.push_back(d); });
+    p.changed().connect([&changes](const std::vector<int>&) { changes++; });
+
+    p.push_back(1);
+    p.push_back(3);
+    p.insert(1, 2);
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), p.get());
+
+    EXPECT_TRUE(p.replace(2, 4));
+    EXPECT_FALSE(p.replace(2, 4));
+    p.erase(0);
+
+    EXPECT_EQ(std::vector<int>({2, 4}), p.get());
+    EXPECT_EQ(2u, p.size());
+    EXPECT_EQ(5u, changes);
+
+    ASSERT_EQ(5u, deltas.size());
+    EXPECT_EQ(core::CollectionOperation::insert, deltas[0].operation);
+    EXPECT_EQ(0u, deltas[0].key);
+    EXPECT_EQ(core::CollectionOperation::insert, deltas[2].operation);
+    EXPECT_EQ(1u, deltas[2].key);
+    EXPECT_EQ(2, deltas[2].value);
+    EXPECT_EQ(core::CollectionOperation::replace, deltas[3].operation);
+    EXPECT_EQ(4, deltas[3].value);
+    EXPECT_EQ(core::CollectionOperation::erase, deltas[4].operation);
+    EXPECT_EQ(0u, deltas[4].key);
+    EXPECT_EQ(1, deltas[4].value);
+}
+
+TEST(CollectionProperty, assigning_the_whole_collection_emits_a_reset)
+{
+    core::CollectionProperty<std::vector<int>> p{std::vector<int>{1, 2}};
+
+    std::vector<core::CollectionOperation> operations;
+    p.delta().connect([&operations](const core::CollectionDelta<std::size_t, int>& d) { operations.push_back(d.operation); });
+
+    p.set(std::vector<int>{1, 2});
+    EXPECT_TRUE(operations.empty());
+
+    p.set(std::vector<int>{3});
+    p.update([](std::vector<int>& v) { v.push_back(4); return true; });
+
+    EXPECT_EQ(std::vector<int>({3, 4}), p.get());
+    EXPECT_EQ(std::vector<core::CollectionOperation>(2, core::CollectionOperation::reset), operations);
+}
+
+TEST(CollectionProperty, map_mutators_emit_deltas)
+{
+    core::CollectionProperty<std::map<std::string, int>> p;
+
+    std::vector<core::CollectionDelta<std::string, int>> deltas;
+    p.delta().connect([&deltas](const core::CollectionDelta<std::string, int>& d) { deltas.push_back(d); });
+
+    EXPECT_TRUE(p.insert_or_assign("a", 1));
+    EXPECT_FALSE(p.insert_or_assign("a", 1));
+    EXPECT_TRUE(p.insert_or_assign("a", 2));
+    EXPECT_TRUE(p.erase("a"));
+    EXPECT_FALSE(p.erase("a"));
+
+    ASSERT_EQ(3u, deltas.size());
+    EXPECT_EQ(core::CollectionOperation::insert, deltas[0].operation);
+    EXPECT_EQ(core::CollectionOperation::replace, deltas[1].operation);
+    EXPECT_EQ(2, deltas[1].value);
+    EXPECT_EQ(core::CollectionOperation::erase, deltas[2].operation);
+    EXPECT_EQ("a", deltas[2].key);
+    EXPECT_EQ(2, deltas[2].value);
+    EXPECT_TRUE(p.get().empty());
+}
+
+TEST(CollectionProperty, element_mutations_are_dispatched_to_the_setter)
+{
+    core::CollectionProperty<std::vector<int>> v;
+
+    std::vector<std::vector<int>> stored;
+    v.install([&stored](const std::vector<int>& value) { stored.push_back(value); });
+
+    bool setter_ran_first = false;
+    v.delta().connect([&stored, &setter_ran_first](const core::CollectionProperty<std::vector<int>>::Delta&)
+    {
+        setter_ran_first = !stored.empty();
+    });
+
+    v.push_back(1);
+    EXPECT_TRUE(setter_ran_first);
+    v.push_back(2);
+    EXPECT_FALSE(v.replace(0, 1));
+    EXPECT_TRUE(v.replace(0, 3));
+    v.erase(1);
+
+    EXPECT_EQ((std::vector<std::vector<int>>{{1}, {1, 2}, {3, 2}, {3}}), stored);
+
+    core::CollectionProperty<std::map<std::string, int>> m;
+
+    std::vector<std::size_t> sizes;
+    m.install([&sizes](const std::map<std::string, int>& value) { sizes.push_back(value.size()); });
+
+    m.insert_or_assign("a", 1);
+    m.insert_or_assign("a", 1);
+    m.insert_or_assign("b", 2);
+    m.erase("a");
+
+    EXPECT_EQ((std::vector<std::size_t>{1, 2, 1}), sizes);
+}
+
+TEST(CollectionProperty, deltas_are_immediate_within_transactions_while_changed_coalesces)
+{
+    core::CollectionProperty<std::unordered_map<int, int>> p;
+
+    std::size_t deltas = 0;
+    std::size_t changes = 0;
+    p.delta().connect([&deltas](const core::CollectionDelta<int, int>&) { deltas++; });
+    p.changed().connect([&changes](const std::unordered_map<int, int>&) { changes++; });
+
+    {
+        core::Transaction transaction;
+        p.insert_or_assign(1, 1);
+        p.insert_or_assign(2, 2);
+        EXPECT_EQ(2u, deltas);
+        EXPECT_EQ(0u, changes);
+    }
+
+    EXPECT_EQ(1u, changes);
+    EXPECT_EQ(2u, p.size());
+}
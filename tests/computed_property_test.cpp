@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/computed_property.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+TEST(ComputedProperty, value_is_computed_from_dependencies)
+{
+    core::Property<int> a{1}, b{2};
+    core::ComputedProperty<int> sum{[&a, &b]() { return a.get() + b.get(); }, a, b};
+
+    EXPECT_EQ(3, sum.get());
+
+    a.set(40);
+    EXPECT_EQ(42, sum);
+}
+
+TEST(ComputedProperty, value_is_only_recomputed_on_access_after_a_change)
+{
+    core::Property<int> a{1};
+
+    unsigned int computation_count = 0;
+    core::ComputedProperty<int> twice{[&a, &computation_count]() { computation_count++; return 2 * a.get(); }, a};
+
+    EXPECT_EQ(0u, computation_count);
+    EXPECT_EQ(2, twice.get());
+    EXPECT_EQ(2, twice.get());
+    EXPECT_EQ(1u, computation_count);
+
+    a.set(2);
+    a.set(3);
+    a.set(4);
+    EXPECT_TRUE(twice.is_dirty());
+    EXPECT_EQ(1u, computation_count);
+
+    EXPECT_EQ(8, twice.get());
+    EXPECT_EQ(2u, computation_count);
+}
+
+TEST(ComputedProperty, changed_is_only_emitted_if_the_recomputed_value_differs)
+{
+    core::Property<int> a{1};
+    core::ComputedProperty<bool> positive{[&a]() { return a.get() > 0; }, a};
+
+    unsigned int invocation_count = 0;
+    bool last_value = true;
+    positive.changed().connect([&invocation_count, &last_value](bool value) { invocation_count++; last_value = value; });
+
+    EXPECT_TRUE(positive.get());
+
+    a.set(2);
+    EXPECT_TRUE(positive.get());
+    EXPECT_EQ(0u, invocation_count);
+
+    a.set(-1);
+    EXPECT_FALSE(positive.get());
+    EXPECT_EQ(1u, invocation_count);
+    EXPECT_FALSE(last_value);
+}
+
+TEST(ComputedProperty, changed_is_only_emitted_by_read_accesses)
+{
+    core::Property<int> a{1};
+    core::ComputedProperty<int> twice{[&a]() { return 2 * a.get(); }, a};
+
+    std::vector<int> values;
+    twice.changed().connect([&values](int value) { values.push_back(value); });
+
+    EXPECT_EQ(2, twice.get());
+
+    a.set(2);
+    EXPECT_TRUE(values.empty());
+    EXPECT_EQ(4, twice.get());
+    EXPECT_EQ((std::vector<int>{4}), values);
+
+    // Reading on invalidation turns the notifications into push-style ones.
+    twice.invalidated().connect([&twice]() { twice.get(); });
+
+    a.set(3);
+    EXPECT_EQ((std::vector<int>{4, 6}), values);
+}
+
+TEST(ComputedProperty, invalidation_propagates_through_computed_dependencies)
+{
+    core::Property<int> a{1};
+    core::ComputedProperty<int> twice{[&a]() { return 2 * a.get(); }, a};
+    core::ComputedProperty<int> twice_plus_one{[&twice]() { return twice.get() + 1; }, twice};
+
+    EXPECT_EQ(3, twice_plus_one.get());
+
+    a.set(2);
+    EXPECT_TRUE(twice.is_dirty());
+    EXPECT_TRUE(twice_plus_one.is_dirty());
+    EXPECT_EQ(5, twice_plus_one.get());
+}
+
+TEST(ComputedProperty, a_throwing_computation_leaves_the_value_dirty)
+{
+    core::Property<int> a{1};
+
+    bool fail = false;
+    core::ComputedProperty<int> twice{[&a, &fail]()
+    {
+        if (fail)
+            throw std::runtime_error{"computation failed"};
+
+        return 2 * a.get();
+    }, a};
+
+    EXPECT_EQ(2, twice.get());
+
+    fail = true;
+    a.set(2);
+    EXPECT_THROW(twice.get(), std::runtime_error);
+    EXPECT_TRUE(twice.is_dirty());
+
+    fail = false;
+    EXPECT_EQ(4, twice.get());
+    EXPECT_FALSE(twice.is_dirty());
+}
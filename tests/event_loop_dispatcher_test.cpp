@@ -0,0 +1,254 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/event_loop_dispatcher.h>
+#include <core/signal.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::atomic<std::size_t> allocation_count{0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+
+    if (void* p = std::malloc(size))
+        return p;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+TEST(EventLoopDispatcher, run_once_executes_pending_handlers_in_order)
+{
+    core::EventLoopDispatcher dispatcher{8};
+
+    std::vector<int> values;
+    for (int i = 0; i < 5; i++)
+        EXPECT_TRUE(dispatcher.try_dispatch([&values, i]() { values.push_back(i); }));
+
+    EXPECT_EQ(5u, dispatcher.run_once());
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4}), values);
+    EXPECT_EQ(0u, dispatcher.run_once());
+}
+
+TEST(EventLoopDispatcher, try_dispatch_fails_if_the_ring_is_full)
+{
+    core::EventLoopDispatcher dispatcher{4};
+    EXPECT_EQ(4u, dispatcher.capacity());
+
+    for (std::size_t i = 0; i < dispatcher.capacity(); i++)
+        EXPECT_TRUE(dispatcher.try_dispatch([]() {}));
+
+    EXPECT_FALSE(dispatcher.try_dispatch([]() {}));
+
+    dispatcher.run_once();
+    EXPECT_TRUE(dispatcher.try_dispatch([]() {}));
+}
+
+TEST(EventLoopDispatcher, handlers_dispatched_by_the_event_loop_into_a_full_ring_are_executed_right_away)
+{
+    core::EventLoopDispatcher dispatcher{2};
+
+    std::vector<int> values;
+    EXPECT_TRUE(dispatcher.try_dispatch([&dispatcher, &values]()
+    {
+        for (int i = 0; i < 4; i++)
+            dispatcher.dispatch([&values, i]() { values.push_back(i); });
+    }));
+
+    EXPECT_EQ(1u, dispatcher.run_once());
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), values);
+    EXPECT_EQ(1u, dispatcher.run_once());
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 0}), values);
+}
+
+TEST(EventLoopDispatcher, signal_emissions_from_the_event_loop_into_a_full_ring_are_executed_right_away)
+{
+    core::EventLoopDispatcher dispatcher{2};
+
+    core::Signal<int> s;
+
+    std::vector<int> values;
+    auto connection = s.connect([&values](int i) { values.push_back(i); });
+    connection.dispatch_via(dispatcher.dispatcher());
+
+    EXPECT_TRUE(dispatcher.try_dispatch([&s]()
+    {
+        for (int i = 0; i < 4; i++)
+            s(i);
+    }));
+
+    EXPECT_EQ(1u, dispatcher.run_once());
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), values);
+    EXPECT_EQ(1u, dispatcher.run_once());
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 0}), values);
+}
+
+TEST(EventLoopDispatcher, signal_emissions_from_many_threads_are_executed_on_the_event_loop_thread)
+{
+    static const unsigned int thread_count = 4;
+    static const unsigned int emissions_per_thread = 10000;
+
+    core::EventLoopDispatcher dispatcher{256};
+    std::thread dispatcher_thread{[&dispatcher]() { dispatcher.run(); }};
+    std::thread::id dispatcher_thread_id = dispatcher_thread.get_id();
+
+    core::Signal<int> s;
+
+    unsigned int invocation_count = 0;
+    auto connection = s.connect(
+                [&dispatcher, &invocation_count, dispatcher_thread_id](int)
+                {
+                    EXPECT_EQ(dispatcher_thread_id, std::this_thread::get_id());
+
+                    if (++invocation_count == thread_count * emissions_per_thread)
+                        dispatcher.stop();
+                });
+    connection.dispatch_via(dispatcher.dispatcher());
+
+    std::vector<std::thread> emitters;
+    for (unsigned int i = 0; i < thread_count; i++)
+        emitters.emplace_back([&s]()
+        {
+            for (unsigned int j = 0; j < emissions_per_thread; j++)
+                s(j);
+        });
+
+    for (auto& emitter : emitters)
+        emitter.join();
+
+    dispatcher_thread.join();
+
+    EXPECT_EQ(thread_count * emissions_per_thread, invocation_count);
+}
+
+TEST(EventLoopDispatcher, queueing_and_executing_signal_emissions_does_not_allocate)
+{
+    core::EventLoopDispatcher dispatcher{8};
+
+    core::Signal<int, double> s;
+
+    int sum = 0;
+    auto connection = s.connect([&sum](int i, double) { sum += i; });
+    connection.dispatch_via(dispatcher.dispatcher());
+
+    auto allocations_before = allocation_count.load();
+
+    for (int i = 1; i <= 4; i++)
+        s(i, 0.);
+
+    EXPECT_EQ(4u, dispatcher.run_once());
+    EXPECT_EQ(allocations_before, allocation_count.load());
+    EXPECT_EQ(10, sum);
+}
+
+TEST(EventLoopDispatcher, queueing_emissions_to_slots_with_large_captures_does_not_allocate)
+{
+    core::EventLoopDispatcher dispatcher{8};
+
+    core::Signal<int> s;
+    core::Signal<void> t;
+
+    // Exceeds the small buffer of std::function, copying the slot would allocate.
+    int sum = 0, offsets[4] = {1, 2, 3, 4};
+    auto c1 = s.connect([&sum, offsets](int i) { sum += i + offsets[3]; });
+    c1.dispatch_via(dispatcher.dispatcher());
+    auto c2 = t.connect([&sum, offsets]() { sum += offsets[0]; });
+    c2.dispatch_via(dispatcher.dispatcher());
+
+    auto allocations_before = allocation_count.load();
+
+    s(1);
+    t();
+    s(2);
+
+    EXPECT_EQ(3u, dispatcher.run_once());
+    EXPECT_EQ(allocations_before, allocation_count.load());
+    EXPECT_EQ(1 + 4 + 1 + 2 + 4, sum);
+}
+
+TEST(EventLoopDispatcher, queued_emissions_outlive_the_disconnection_of_their_slot)
+{
+    core::EventLoopDispatcher dispatcher{8};
+
+    core::Signal<int> s;
+
+    auto state = std::make_shared<int>(0);
+    std::weak_ptr<int> observer{state};
+
+    auto c = s.connect([state](int i) { *state += i; });
+    c.dispatch_via(dispatcher.dispatcher());
+    state.reset();
+
+    s(42);
+    c.disconnect();
+    EXPECT_FALSE(observer.expired());
+
+    EXPECT_EQ(1u, dispatcher.run_once());
+    EXPECT_TRUE(observer.expired());
+}
+
+TEST(EventLoopDispatcher, handlers_exceeding_the_inline_capacity_are_still_executed)
+{
+    core::EventLoopDispatcher dispatcher{8};
+
+    core::Signal<std::string, std::string> s;
+
+    std::string received;
+    auto connection = s.connect([&received](const std::string& lhs, const std::string& rhs) { received = lhs + rhs; });
+    connection.dispatch_via(dispatcher.dispatcher());
+
+    s(std::string(100, 'a'), std::string(100, 'b'));
+
+    EXPECT_EQ(1u, dispatcher.run_once());
+    EXPECT_EQ(std::string(100, 'a') + std::string(100, 'b'), received);
+}
+
+TEST(EventLoopDispatcher, pending_handlers_are_destroyed_with_the_dispatcher)
+{
+    auto token = std::make_shared<int>(42);
+
+    {
+        core::EventLoopDispatcher dispatcher{8};
+        EXPECT_TRUE(dispatcher.try_dispatch([token]() {}));
+        EXPECT_EQ(2, token.use_count());
+    }
+
+    EXPECT_EQ(1, token.use_count());
+}
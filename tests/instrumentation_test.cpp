@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/signal.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+
+static_assert(PROPERTIES_CPP_ENABLE_INSTRUMENTATION, "This test requires instrumentation to be enabled.");
+
+namespace
+{
+std::shared_ptr<const core::instrumentation::SignalStatistics> statistics_for(const std::string& name)
+{
+    auto signals = core::instrumentation::Registry::instance().signals();
+    auto it = std::find_if(
+                signals.begin(),
+                signals.end(),
+                [&name](const std::shared_ptr<const core::instrumentation::SignalStatistics>& s)
+                {
+                    return s->name() == name;
+                });
+
+    return it == signals.end() ? nullptr : *it;
+}
+}
+
+TEST(Instrumentation, live_signals_are_enumerated_by_the_registry)
+{
+    {
+        core::Signal<int> s{"live_signal"};
+        EXPECT_NE(nullptr, statistics_for("live_signal"));
+    }
+
+    EXPECT_EQ(nullptr, statistics_for("live_signal"));
+}
+
+TEST(Instrumentation, emissions_and_slot_invocations_are_counted)
+{
+    core::Signal<int> s{"counted_signal"};
+    auto statistics = statistics_for("counted_signal");
+    ASSERT_NE(nullptr, statistics);
+
+    auto c1 = s.connect([](int) {});
+    auto c2 = s.connect([](int) {});
+    EXPECT_EQ(2u, statistics->slot_count());
+
+    s(42);
+    s(43);
+    EXPECT_EQ(2u, statistics->emit_count());
+    EXPECT_EQ(4u, statistics->invocation_count());
+
+    c1.disconnect();
+    EXPECT_EQ(1u, statistics->slot_count());
+    EXPECT_LT(0, statistics->guard_hold_duration().count());
+}
+
+TEST(Instrumentation, slot_execution_times_are_recorded_in_histograms)
+{
+    core::Signal<void> s{"timed_signal"};
+    auto statistics = statistics_for("timed_signal");
+    ASSERT_NE(nullptr, statistics);
+
+    auto connection = s.connect([]() {});
+
+    for (unsigned int i = 0; i < 10; i++)
+        s();
+
+    auto histograms = statistics->slot_histograms();
+    ASSERT_EQ(1u, histograms.size());
+    EXPECT_EQ(10u, histograms.front().second->count());
+}
+
+TEST(Instrumentation, keyed_slots_report_to_the_statistics_of_their_signal)
+{
+    auto signals_before = core::instrumentation::Registry::instance().signals().size();
+
+    core::Signal<int> s{"keyed_signal"};
+    auto statistics = statistics_for("keyed_signal");
+    ASSERT_NE(nullptr, statistics);
+
+    auto c1 = s.connect([](int) {});
+    auto c2 = s.connect_keyed(1, [](int) {});
+    auto c3 = s.connect_keyed(2, [](int) {});
+    EXPECT_EQ(3u, statistics->slot_count());
+    EXPECT_EQ(3u, statistics->slot_histograms().size());
+    EXPECT_EQ(signals_before + 1, core::instrumentation::Registry::instance().signals().size());
+
+    s(1);
+    s(3);
+    EXPECT_EQ(2u, statistics->emit_count());
+    EXPECT_EQ(3u, statistics->invocation_count());
+
+    c2.disconnect();
+    EXPECT_EQ(2u, statistics->slot_count());
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/plain_property.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <type_traits>
+
+static_assert(!std::is_polymorphic<core::PlainProperty<int>>::value, "PlainProperty must not dispatch virtually");
+
+TEST(PlainProperty, set_stores_the_value_and_notifies_on_change)
+{
+    core::PlainProperty<std::string> p{"a"};
+
+    unsigned int notifications = 0;
+    p.changed().connect([&notifications](const std::string&) { notifications++; });
+
+    p.set("a");
+    EXPECT_EQ(0u, notifications);
+
+    p = "b";
+    EXPECT_EQ("b", p.get());
+    EXPECT_EQ(1u, p->size());
+    EXPECT_EQ(1u, notifications);
+}
+
+TEST(PlainProperty, update_notifies_iff_the_functor_reports_a_change)
+{
+    core::PlainProperty<int> p{41};
+
+    unsigned int notifications = 0;
+    p.changed().connect([&notifications](int) { notifications++; });
+
+    EXPECT_FALSE(p.update([](int&) { return false; }));
+    EXPECT_TRUE(p.update([](int& i) { i++; return true; }));
+
+    EXPECT_EQ(42, p.get());
+    EXPECT_EQ(1u, notifications);
+}
+
+TEST(PlainProperty, changes_within_transactions_are_coalesced)
+{
+    core::PlainProperty<int> p;
+
+    std::vector<int> notifications;
+    p.changed().connect([&notifications](int i) { notifications.push_back(i); });
+
+    {
+        core::Transaction transaction;
+        p.set(1);
+        p.set(2);
+    }
+
+    EXPECT_EQ(std::vector<int>{2}, notifications);
+}
+
+TEST(PlainProperty, copies_only_copy_the_value)
+{
+    core::PlainProperty<int> p{42};
+
+    unsigned int notifications = 0;
+    p.changed().connect([&notifications](int) { notifications++; });
+
+    core::PlainProperty<int> copy{p};
+    copy.set(43);
+
+    EXPECT_EQ(42, p.get());
+    EXPECT_EQ(0u, notifications);
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/pooled_signal.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace
+{
+std::atomic<std::size_t> allocation_count{0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+
+    if (void* p = std::malloc(size))
+        return p;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+TEST(PoolAllocator, freed_blocks_are_reused_by_the_same_thread)
+{
+    core::PoolAllocator<int> allocator;
+
+    int* first = allocator.allocate(10);
+    allocator.deallocate(first, 10);
+
+    int* second = allocator.allocate(12);
+    EXPECT_EQ(first, second);
+    allocator.deallocate(second, 12);
+}
+
+TEST(PoolAllocator, large_requests_bypass_the_pool)
+{
+    core::PoolAllocator<char> allocator;
+
+    auto allocations_before = allocation_count.load();
+    char* p = allocator.allocate(1 << 20);
+    EXPECT_EQ(allocations_before + 1, allocation_count.load());
+    allocator.deallocate(p, 1 << 20);
+}
+
+TEST(PooledSignal, emission_and_disconnect_work)
+{
+    core::PooledSignal<int> s;
+
+    std::vector<int> values;
+    auto c1 = s.connect([&values](int value) { values.push_back(value); });
+    auto c2 = s.connect([&values](int value) { values.push_back(-value); });
+
+    s(42);
+    c1.disconnect();
+    s(43);
+
+    EXPECT_EQ((std::vector<int>{42, -42, -43}), values);
+    EXPECT_TRUE(c2.is_connected());
+}
+
+TEST(PooledSignal, connect_and_disconnect_churn_does_not_hit_the_global_heap)
+{
+    core::PooledSignal<int> s;
+
+    int sum = 0;
+    auto c1 = s.connect([&sum](int value) { sum += value; });
+    auto c2 = s.connect([&sum](int value) { sum -= value; });
+
+    // Warm up the pool and the internal bookkeeping of the signal.
+    for (int i = 0; i < 16; i++)
+        s.connect([&sum](int value) { sum += value; }).disconnect();
+
+    auto allocations_before = allocation_count.load();
+    for (int i = 0; i < 1000; i++)
+    {
+        auto connection = s.connect([&sum](int value) { sum += value; });
+        s(1);
+        connection.disconnect();
+    }
+
+    EXPECT_EQ(allocations_before, allocation_count.load());
+    EXPECT_EQ(1000, sum);
+}
@@ -20,6 +20,12 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
 TEST(Property, default_construction_yields_default_value)
 {
     core::Property<int> p1;
@@ -208,3 +214,332 @@ TEST(Property, setter_is_invoked_for_set_operations)
     prop.set(42);
     EXPECT_EQ(42, value);
 }
+
+namespace
+{
+struct CopyCounter
+{
+    CopyCounter(int value = 0) : value(value)
+    {
+    }
+
+    CopyCounter(const CopyCounter& rhs) : value(rhs.value)
+    {
+        copy_count++;
+    }
+
+    CopyCounter(CopyCounter&& rhs) : value(rhs.value)
+    {
+    }
+
+    CopyCounter& operator=(const CopyCounter& rhs)
+    {
+        value = rhs.value;
+        copy_count++;
+        return *this;
+    }
+
+    CopyCounter& operator=(CopyCounter&& rhs)
+    {
+        value = rhs.value;
+        return *this;
+    }
+
+    bool operator!=(const CopyCounter& rhs) const
+    {
+        return value != rhs.value;
+    }
+
+    bool operator==(const CopyCounter& rhs) const
+    {
+        return value == rhs.value;
+    }
+
+    int value;
+    static unsigned int copy_count;
+};
+
+unsigned int CopyCounter::copy_count = 0;
+}
+
+TEST(Property, setting_an_rvalue_moves_the_value)
+{
+    core::Property<CopyCounter> p;
+    CopyCounter::copy_count = 0;
+
+    p.set(CopyCounter{42});
+    p = CopyCounter{43};
+
+    EXPECT_EQ(43, p.get().value);
+    EXPECT_EQ(0u, CopyCounter::copy_count);
+}
+
+TEST(Property, emplace_constructs_and_moves_the_value)
+{
+    core::Property<std::string> p;
+
+    unsigned int invocation_count = 0;
+    p.changed().connect([&invocation_count](const std::string&) { invocation_count++; });
+
+    p.emplace(3, 'a');
+    EXPECT_EQ("aaa", p.get());
+    EXPECT_EQ(1u, invocation_count);
+
+    // Emplacing an equal value does not notify observers.
+    p.emplace("aaa");
+    EXPECT_EQ(1u, invocation_count);
+}
+
+namespace
+{
+// Only accepts positive values, clamping everything else to 1.
+struct PositiveProperty : public core::Property<CopyCounter>
+{
+    void set(const CopyCounter& new_value) override
+    {
+        set_count++;
+
+        if (new_value.value > 0)
+            core::Property<CopyCounter>::set(new_value);
+        else
+            core::Property<CopyCounter>::set(CopyCounter{1});
+    }
+
+    using core::Property<CopyCounter>::operator=;
+    unsigned int set_count = 0;
+};
+}
+
+TEST(Property, rvalues_are_dispatched_to_overrides_of_set)
+{
+    PositiveProperty derived;
+    core::Property<CopyCounter>& p = derived;
+    CopyCounter::copy_count = 0;
+
+    p.set(CopyCounter{-1});
+    EXPECT_EQ(1, p.get().value);
+
+    p = CopyCounter{-2};
+    p.emplace(-3);
+    EXPECT_EQ(1, p.get().value);
+    EXPECT_EQ(3u, derived.set_count);
+
+    // Values the override passes on unchanged are still moved.
+    p.set(CopyCounter{42});
+    EXPECT_EQ(42, p.get().value);
+    EXPECT_EQ(0u, CopyCounter::copy_count);
+}
+
+TEST(Property, changes_within_a_transaction_are_notified_once_on_commit)
+{
+    core::Property<int> p1, p2;
+
+    std::vector<int> p1_values, p2_values;
+    p1.changed().connect([&p1_values](int value) { p1_values.push_back(value); });
+    p2.changed().connect([&p2_values](int value) { p2_values.push_back(value); });
+
+    {
+        core::Transaction transaction;
+
+        p1.set(1);
+        p1.set(2);
+        p2 = 3;
+        p1.update([](int& value) { value = 4; return true; });
+
+        EXPECT_TRUE(p1_values.empty());
+        EXPECT_TRUE(p2_values.empty());
+    }
+
+    EXPECT_EQ(std::vector<int>{4}, p1_values);
+    EXPECT_EQ(std::vector<int>{3}, p2_values);
+
+    // Once the transaction has been committed, changes are notified immediately.
+    p1.set(5);
+    EXPECT_EQ((std::vector<int>{4, 5}), p1_values);
+}
+
+TEST(Property, only_the_outermost_transaction_delivers_notifications)
+{
+    core::Property<int> p;
+
+    unsigned int invocation_count = 0;
+    p.changed().connect([&invocation_count](int) { invocation_count++; });
+
+    core::Transaction outer;
+    {
+        core::Transaction inner;
+        p.set(42);
+        inner.commit();
+        EXPECT_EQ(0u, invocation_count);
+    }
+
+    p.set(43);
+    outer.commit();
+
+    EXPECT_EQ(1u, invocation_count);
+    EXPECT_FALSE(core::Transaction::is_active());
+}
+
+TEST(Property, destroying_a_property_discards_its_pending_notification)
+{
+    core::Transaction transaction;
+    {
+        core::Property<int> p;
+        p.set(42);
+    }
+
+    EXPECT_NO_THROW(transaction.commit());
+}
+
+TEST(Property, throwing_observer_does_not_drop_the_remaining_notifications)
+{
+    core::Property<int> p1, p2;
+
+    p1.changed().connect([](int) { throw std::runtime_error{"p1"}; });
+
+    std::vector<int> p2_values;
+    p2.changed().connect([&p2_values](int value) { p2_values.push_back(value); });
+
+    {
+        core::Transaction transaction;
+        p1.set(1);
+        p2.set(2);
+
+        EXPECT_THROW(transaction.commit(), std::runtime_error);
+    }
+
+    EXPECT_EQ(std::vector<int>{2}, p2_values);
+
+    // The property still notifies within subsequent transactions.
+    {
+        core::Transaction transaction;
+        p2.set(3);
+    }
+
+    EXPECT_EQ((std::vector<int>{2, 3}), p2_values);
+}
+
+TEST(Property, observer_destroying_a_pending_property_discards_its_notification)
+{
+    core::Property<int> p1;
+    std::unique_ptr<core::Property<int>> p2{new core::Property<int>{}};
+
+    p1.changed().connect([&p2](int) { p2.reset(); });
+
+    {
+        core::Transaction transaction;
+        p1.set(1);
+        p2->set(2);
+    }
+
+    EXPECT_EQ(nullptr, p2.get());
+}
+
+TEST(Property, cached_getter_is_only_invoked_after_invalidation)
+{
+    unsigned int invocation_count = 0;
+    auto getter = [&invocation_count]()
+    {
+        invocation_count++;
+        return 42;
+    };
+
+    core::Property<int> prop;
+    prop.install(getter, core::Property<int>::until_invalidated());
+
+    EXPECT_EQ(42, prop.get());
+    EXPECT_EQ(42, prop);
+    EXPECT_EQ(1u, invocation_count);
+
+    prop.invalidate();
+    EXPECT_EQ(42, prop.get());
+    EXPECT_EQ(2u, invocation_count);
+
+    auto statistics = prop.cache_statistics();
+    EXPECT_EQ(1u, statistics.hits);
+    EXPECT_EQ(2u, statistics.misses);
+}
+
+TEST(Property, cached_getter_is_invoked_again_once_the_ttl_elapsed)
+{
+    unsigned int invocation_count = 0;
+    auto getter = [&invocation_count]()
+    {
+        invocation_count++;
+        return 42;
+    };
+
+    core::Property<int> prop;
+    prop.install(getter, std::chrono::milliseconds{10});
+
+    prop.get();
+    prop.get();
+    EXPECT_EQ(1u, invocation_count);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    prop.get();
+    EXPECT_EQ(2u, invocation_count);
+}
+
+namespace
+{
+struct Blob
+{
+    unsigned int version() const
+    {
+        return stamp;
+    }
+
+    bool operator==(const Blob&) const
+    {
+        // Deep comparisons must never be reached when comparing by version.
+        ADD_FAILURE();
+        return false;
+    }
+
+    unsigned int stamp;
+    std::string payload;
+};
+}
+
+TEST(Property, always_notify_policy_notifies_on_every_set)
+{
+    core::Property<int, core::AlwaysNotify> prop{42};
+
+    unsigned int notifications = 0;
+    prop.changed().connect([&notifications](int) { notifications++; });
+
+    prop.set(42);
+    prop.set(42);
+    EXPECT_EQ(2u, notifications);
+}
+
+TEST(Property, by_version_policy_compares_stamps_only)
+{
+    core::Property<Blob, core::ByVersion> prop{Blob{1, "a"}};
+
+    unsigned int notifications = 0;
+    prop.changed().connect([&notifications](const Blob&) { notifications++; });
+
+    prop.set(Blob{1, "b"});
+    EXPECT_EQ(0u, notifications);
+    EXPECT_EQ("a", prop.get().payload);
+
+    prop.set(Blob{2, "b"});
+    EXPECT_EQ(1u, notifications);
+    EXPECT_EQ("b", prop.get().payload);
+}
+
+TEST(Property, by_hash_policy_compares_hashes)
+{
+    core::Property<std::string, core::ByHash<>> prop{"a"};
+
+    unsigned int notifications = 0;
+    prop.changed().connect([&notifications](const std::string&) { notifications++; });
+
+    prop.set("a");
+    EXPECT_EQ(0u, notifications);
+    prop.set("b");
+    EXPECT_EQ(1u, notifications);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/property_registry.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <unistd.h>
+
+namespace
+{
+std::atomic<std::size_t> allocation_count{0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+
+    if (void* p = std::malloc(size))
+        return p;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+TEST(PropertyRegistry, keys_are_unique)
+{
+    core::Property<int> a;
+    core::Property<int> b;
+
+    core::PropertyRegistry registry;
+    EXPECT_TRUE(registry.add("a", a));
+    EXPECT_FALSE(registry.add("a", b));
+    EXPECT_EQ(1u, registry.size());
+
+    EXPECT_TRUE(registry.remove("a"));
+    EXPECT_FALSE(registry.remove("a"));
+}
+
+TEST(PropertyRegistry, snapshots_restore_all_registered_values)
+{
+    core::Property<int> volume{7};
+    core::Property<double> brightness{0.5};
+    core::Property<std::string> name{"device"};
+
+    core::PropertyRegistry source;
+    source.add("volume", volume);
+    source.add("brightness", brightness);
+    source.add("name", name);
+
+    auto snapshot = source.snapshot();
+
+    core::Property<int> restored_volume;
+    core::Property<double> restored_brightness;
+    core::Property<std::string> restored_name;
+
+    core::PropertyRegistry target;
+    target.add("volume", restored_volume);
+    target.add("brightness", restored_brightness);
+    target.add("name", restored_name);
+
+    EXPECT_EQ(3u, target.restore(snapshot.data(), snapshot.size()));
+    EXPECT_EQ(7, restored_volume.get());
+    EXPECT_DOUBLE_EQ(0.5, restored_brightness.get());
+    EXPECT_EQ("device", restored_name.get());
+}
+
+TEST(PropertyRegistry, restoring_trivially_copyable_values_does_not_allocate)
+{
+    core::Property<int> volume{7};
+    core::Property<double> brightness{0.5};
+
+    // Keys exceed the small string buffer of std::string.
+    core::PropertyRegistry registry;
+    registry.add("settings.audio.output.volume", volume);
+    registry.add("settings.display.brightness", brightness);
+
+    auto snapshot = registry.snapshot();
+    volume.set(8);
+    brightness.set(1.);
+
+    // Warms up the list of pending notifications, which keeps its capacity.
+    EXPECT_EQ(2u, registry.restore(snapshot.data(), snapshot.size()));
+    volume.set(8);
+    brightness.set(1.);
+
+    auto allocations_before = allocation_count.load();
+    EXPECT_EQ(2u, registry.restore(snapshot.data(), snapshot.size()));
+    EXPECT_EQ(allocations_before, allocation_count.load());
+
+    EXPECT_EQ(7, volume.get());
+    EXPECT_DOUBLE_EQ(0.5, brightness.get());
+}
+
+TEST(PropertyRegistry, restoring_notifies_once_all_values_are_in_place)
+{
+    core::Property<int> a{1};
+    core::Property<int> b{2};
+
+    core::PropertyRegistry registry;
+    registry.add("a", a);
+    registry.add("b", b);
+
+    auto snapshot = registry.snapshot();
+    a.set(0);
+    b.set(0);
+
+    int sum_seen_by_a = 0;
+    unsigned int notifications = 0;
+    a.changed().connect([&](int) { sum_seen_by_a = a.get() + b.get(); notifications++; });
+    b.changed().connect([&](int) { notifications++; });
+
+    EXPECT_EQ(2u, registry.restore(snapshot.data(), snapshot.size()));
+    EXPECT_EQ(2u, notifications);
+    EXPECT_EQ(3, sum_seen_by_a);
+}
+
+TEST(PropertyRegistry, unknown_keys_mismatching_and_truncated_records_are_skipped)
+{
+    core::Property<int> a{1};
+    core::Property<int> b{2};
+
+    core::PropertyRegistry source;
+    source.add("a", a);
+    source.add("b", b);
+    auto snapshot = source.snapshot();
+
+    core::Property<long long> wide;
+    core::PropertyRegistry target;
+    target.add("a", wide);
+
+    EXPECT_EQ(0u, target.restore(snapshot.data(), snapshot.size()));
+    EXPECT_EQ(0u, target.restore(snapshot.data(), snapshot.size() - 1));
+    EXPECT_EQ(0u, target.restore("garbage", 7));
+}
+
+TEST(PropertyRegistry, snapshots_round_trip_through_files)
+{
+    std::string path = "/tmp/properties-cpp-registry-" + std::to_string(::getpid());
+
+    core::Property<int> a{42};
+    core::PropertyRegistry source;
+    source.add("a", a);
+    ASSERT_TRUE(source.dump(path));
+
+    core::Property<int> restored;
+    core::PropertyRegistry target;
+    target.add("a", restored);
+
+    EXPECT_EQ(1u, target.load(path));
+    EXPECT_EQ(42, restored.get());
+    EXPECT_EQ(0u, target.load(path + "-missing"));
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/sharded_signal.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(ShardedSignal, emissions_reach_every_slot_exactly_once)
+{
+    core::ShardedSignal<int> s{4};
+    EXPECT_EQ(4u, s.shard_count());
+
+    int first = 0;
+    int second = 0;
+    s.connect([&first](int value) { first += value; });
+    s.connect([&second](int value) { second += value; });
+
+    s(1);
+    s(2);
+
+    EXPECT_EQ(3, first);
+    EXPECT_EQ(3, second);
+    EXPECT_EQ(2u, s.emission_count());
+}
+
+TEST(ShardedSignal, disconnecting_removes_the_slot_from_all_shards)
+{
+    core::ShardedSignal<int> s{8};
+
+    std::atomic<int> invocations{0};
+    auto c = s.connect([&invocations](int) { invocations++; });
+
+    EXPECT_TRUE(c.is_connected());
+    c.disconnect();
+    EXPECT_FALSE(c.is_connected());
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+        threads.emplace_back([&s]() { for (int j = 0; j < 1000; j++) s(j); });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(0, invocations.load());
+    EXPECT_EQ(4000u, s.emission_count());
+}
+
+TEST(ShardedSignal, concurrent_emissions_are_delivered_from_every_shard)
+{
+    core::ShardedSignal<int> s;
+
+    std::atomic<int> sum{0};
+    s.connect([&sum](int value) { sum += value; }, 1);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++)
+        threads.emplace_back([&s]() { for (int j = 0; j < 1000; j++) s(1); });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(8000, sum.load());
+}
+
+TEST(ShardedSignal, indices_of_disconnected_slots_are_reused)
+{
+    core::ShardedSignal<int> s{2};
+
+    int invocations = 0;
+    auto first = s.connect([&invocations](int) { invocations += 1; });
+    first.disconnect();
+
+    auto second = s.connect([&invocations](int) { invocations += 10; });
+    EXPECT_FALSE(first.is_connected());
+    EXPECT_TRUE(second.is_connected());
+
+    first.disconnect();
+    s(0);
+    EXPECT_EQ(10, invocations);
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/shared_memory_property.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+struct DeviceState
+{
+    bool operator==(const DeviceState& rhs) const
+    {
+        return level == rhs.level && enabled == rhs.enabled;
+    }
+
+    int level;
+    bool enabled;
+};
+
+// Terminates the process when compared while armed, i.e. in the middle of a write.
+struct Fragile
+{
+    bool operator==(const Fragile& rhs) const
+    {
+        if (armed)
+            ::_exit(0);
+
+        return value == rhs.value;
+    }
+
+    static bool armed;
+    int value;
+};
+
+bool Fragile::armed = false;
+
+std::string segment_name(const std::string& test)
+{
+    return "/properties-cpp-" + test + "-" + std::to_string(::getpid());
+}
+
+// Collects notifications emitted on the watcher thread.
+struct Observer
+{
+    void operator()(const DeviceState& state)
+    {
+        std::lock_guard<std::mutex> lg(guard);
+        last = state;
+        notifications++;
+        wait_condition.notify_all();
+    }
+
+    bool wait_for(const DeviceState& state)
+    {
+        std::unique_lock<std::mutex> ul(guard);
+        return wait_condition.wait_for(ul, std::chrono::seconds{5}, [this, &state]() { return notifications > 0 && last == state; });
+    }
+
+    std::mutex guard;
+    std::condition_variable wait_condition;
+    DeviceState last{0, false};
+    unsigned int notifications = 0;
+};
+}
+
+TEST(SharedMemoryProperty, instances_share_the_value)
+{
+    auto name = segment_name("share");
+
+    core::SharedMemoryProperty<DeviceState> first{name, DeviceState{1, true}};
+    core::SharedMemoryProperty<DeviceState> second{name, DeviceState{2, false}};
+
+    EXPECT_EQ(1, second.get().level);
+
+    EXPECT_TRUE(second.set(DeviceState{3, false}));
+    EXPECT_FALSE(second.set(DeviceState{3, false}));
+    EXPECT_EQ(3, first.get().level);
+
+    EXPECT_TRUE(core::SharedMemoryProperty<DeviceState>::remove(name));
+}
+
+TEST(SharedMemoryProperty, remote_writes_are_emitted_locally)
+{
+    auto name = segment_name("remote");
+
+    core::SharedMemoryProperty<DeviceState> local{name};
+    core::SharedMemoryProperty<DeviceState> remote{name};
+
+    Observer observer;
+    local.changed().connect(std::ref(observer));
+
+    unsigned int remote_notifications = 0;
+    remote.changed().connect([&remote_notifications](const DeviceState&) { remote_notifications++; });
+
+    remote.set(DeviceState{42, true});
+    EXPECT_TRUE(observer.wait_for(DeviceState{42, true}));
+    EXPECT_EQ(1u, remote_notifications);
+
+    core::SharedMemoryProperty<DeviceState>::remove(name);
+}
+
+TEST(SharedMemoryProperty, local_writes_are_only_emitted_on_the_writing_thread)
+{
+    auto name = segment_name("local");
+
+    core::SharedMemoryProperty<DeviceState> property{name};
+
+    std::thread::id writer = std::this_thread::get_id();
+    std::atomic<unsigned int> foreign_notifications{0};
+    property.changed().connect([writer, &foreign_notifications](const DeviceState&)
+    {
+        if (std::this_thread::get_id() != writer)
+            foreign_notifications++;
+    });
+
+    // Yielding now and then lets the watcher interleave with the writes.
+    for (int i = 1; i <= 100000; i++)
+    {
+        property.set(DeviceState{i, true});
+
+        if (i % 4 == 0)
+            std::this_thread::yield();
+    }
+
+    // Gives the watcher the chance to catch up with the last write.
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+    EXPECT_EQ(0u, foreign_notifications.load());
+
+    core::SharedMemoryProperty<DeviceState>::remove(name);
+}
+
+TEST(SharedMemoryProperty, values_are_replicated_across_processes)
+{
+    auto name = segment_name("process");
+
+    core::SharedMemoryProperty<DeviceState> local{name};
+
+    Observer observer;
+    local.changed().connect(std::ref(observer));
+
+    pid_t child = ::fork();
+    ASSERT_NE(-1, child);
+
+    if (child == 0)
+    {
+        {
+            core::SharedMemoryProperty<DeviceState> remote{name};
+            remote.set(DeviceState{7, true});
+        }
+        ::_exit(0);
+    }
+
+    EXPECT_TRUE(observer.wait_for(DeviceState{7, true}));
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    EXPECT_EQ(0, status);
+
+    core::SharedMemoryProperty<DeviceState>::remove(name);
+}
+
+TEST(SharedMemoryProperty, opening_a_segment_for_another_type_fails)
+{
+    auto name = segment_name("mismatch");
+
+    core::SharedMemoryProperty<DeviceState> property{name};
+    EXPECT_THROW(core::SharedMemoryProperty<std::uint64_t>{name}, std::system_error);
+
+    core::SharedMemoryProperty<DeviceState>::remove(name);
+}
+
+TEST(SharedMemoryProperty, a_writer_terminating_in_the_middle_of_a_write_is_reported)
+{
+    auto name = segment_name("dead-writer");
+
+    core::SharedMemoryProperty<Fragile> local{name, Fragile{0}, std::chrono::milliseconds{50}};
+
+    pid_t child = ::fork();
+    ASSERT_NE(-1, child);
+
+    if (child == 0)
+    {
+        core::SharedMemoryProperty<Fragile> remote{name};
+        Fragile::armed = true;
+        remote.set(Fragile{1});
+        ::_exit(1);
+    }
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    EXPECT_EQ(0, status);
+
+    try
+    {
+        local.get();
+        FAIL() << "get() did not report the dead writer";
+    } catch(const std::system_error& e)
+    {
+        EXPECT_EQ(EOWNERDEAD, e.code().value());
+    }
+
+    EXPECT_THROW(local.set(Fragile{2}), std::system_error);
+
+    core::SharedMemoryProperty<Fragile>::remove(name);
+}
+
+TEST(SharedMemoryProperty, opening_a_segment_that_is_never_initialized_times_out)
+{
+    auto name = segment_name("uninitialized");
+
+    // A creator that terminated right after creating the segment, before sizing it.
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_NE(-1, fd);
+    ::close(fd);
+
+    try
+    {
+        core::SharedMemoryProperty<DeviceState> property{name, DeviceState{0, false}, std::chrono::milliseconds{50}};
+        FAIL() << "opening did not time out";
+    } catch(const std::system_error& e)
+    {
+        EXPECT_EQ(ETIMEDOUT, e.code().value());
+    }
+
+    core::SharedMemoryProperty<DeviceState>::remove(name);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/shared_property.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(SharedProperty, snapshots_stay_unchanged_after_set)
+{
+    core::SharedProperty<std::vector<int>> p{std::vector<int>{1, 2, 3}};
+
+    auto snapshot = p.get();
+    EXPECT_TRUE(p.set(std::vector<int>{4, 5}));
+
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), *snapshot);
+    EXPECT_EQ((std::vector<int>{4, 5}), *p.get());
+}
+
+TEST(SharedProperty, replaced_snapshots_are_released_by_set)
+{
+    core::SharedProperty<std::vector<int>> p{std::vector<int>{1, 2, 3}};
+
+    std::weak_ptr<const std::vector<int>> replaced = p.get();
+    EXPECT_TRUE(p.set(std::vector<int>{4, 5}));
+    EXPECT_TRUE(replaced.expired());
+
+    auto snapshot = p.get();
+    EXPECT_TRUE(p.set(std::vector<int>{6}));
+    EXPECT_EQ(1, snapshot.use_count());
+}
+
+TEST(SharedProperty, set_emits_changed_only_on_a_real_change)
+{
+    core::SharedProperty<std::string> p{std::string{"42"}};
+
+    unsigned int notification_count = 0;
+    std::string last;
+    p.changed().connect([&](const std::string& s) { notification_count++; last = s; });
+
+    EXPECT_FALSE(p.set("42"));
+    EXPECT_EQ(0u, notification_count);
+
+    EXPECT_TRUE(p.set("43"));
+    EXPECT_EQ(1u, notification_count);
+    EXPECT_EQ("43", last);
+}
+
+namespace
+{
+struct CopyCounter
+{
+    CopyCounter(int value = 0) : value(value)
+    {
+    }
+
+    CopyCounter(const CopyCounter& rhs) : value(rhs.value)
+    {
+        copy_count++;
+    }
+
+    bool operator==(const CopyCounter& rhs) const
+    {
+        return value == rhs.value;
+    }
+
+    int value;
+    static unsigned int copy_count;
+};
+
+unsigned int CopyCounter::copy_count = 0;
+}
+
+TEST(SharedProperty, set_copies_the_new_value_at_most_once)
+{
+    core::SharedProperty<CopyCounter> p{CopyCounter{1}};
+    CopyCounter::copy_count = 0;
+
+    EXPECT_FALSE(p.set(CopyCounter{1}));
+    EXPECT_EQ(0u, CopyCounter::copy_count);
+
+    EXPECT_TRUE(p.set(CopyCounter{2}));
+    EXPECT_EQ(1u, CopyCounter::copy_count);
+    EXPECT_EQ(2, p.get()->value);
+}
+
+TEST(SharedProperty, readers_observe_consistent_snapshots_while_a_writer_updates)
+{
+    static const unsigned int reader_count = 3;
+    static const unsigned int update_count = 2000;
+
+    core::SharedProperty<std::vector<unsigned int>> p{std::vector<unsigned int>(16, 0)};
+
+    std::atomic<bool> done{false};
+    std::atomic<unsigned int> inconsistencies{0};
+
+    std::vector<std::thread> readers;
+    for (unsigned int i = 0; i < reader_count; i++)
+        readers.emplace_back([&]()
+        {
+            while (!done.load())
+            {
+                auto snapshot = p.get();
+                for (auto value : *snapshot)
+                    if (value != snapshot->front())
+                        inconsistencies++;
+            }
+        });
+
+    for (unsigned int i = 1; i <= update_count; i++)
+        p.update([i](std::vector<unsigned int>& v)
+        {
+            for (auto& value : v)
+                value = i;
+            return true;
+        });
+
+    done.store(true);
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(0u, inconsistencies.load());
+    EXPECT_EQ(update_count, p.get()->back());
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/event_loop_dispatcher.h>
+#include <core/property.h>
+#include <core/signal.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <coroutine>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <tuple>
+
+namespace
+{
+std::atomic<std::size_t> allocation_count{0};
+
+// A coroutine that starts eagerly and is destroyed together with its Task.
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object()
+        {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::abort(); }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle)
+    {
+    }
+
+    Task(Task&& rhs) : handle(rhs.handle)
+    {
+        rhs.handle = nullptr;
+    }
+
+    ~Task()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    bool done() const
+    {
+        return handle.done();
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+}
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+
+    if (void* p = std::malloc(size))
+        return p;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+TEST(SignalAwaitable, next_completes_with_the_emitted_value)
+{
+    core::Signal<int> s;
+
+    int received = 0;
+    auto coroutine = [&]() -> Task { received = co_await s.next(); };
+    auto task = coroutine();
+
+    EXPECT_FALSE(task.done());
+    s(42);
+    EXPECT_TRUE(task.done());
+    EXPECT_EQ(42, received);
+}
+
+TEST(SignalAwaitable, signals_with_several_or_no_arguments_can_be_awaited)
+{
+    core::Signal<int, std::string> s;
+    core::Signal<void> sv;
+
+    std::tuple<int, std::string> received;
+    bool void_received = false;
+
+    auto coroutine = [&]() -> Task { received = co_await s.next(); };
+    auto void_coroutine = [&]() -> Task { co_await sv.next(); void_received = true; };
+
+    auto task = coroutine();
+    auto void_task = void_coroutine();
+
+    s(42, "42");
+    sv();
+
+    EXPECT_EQ(std::make_tuple(42, std::string{"42"}), received);
+    EXPECT_TRUE(void_received);
+}
+
+TEST(SignalAwaitable, waiting_and_resuming_does_not_allocate)
+{
+    core::Signal<int> s;
+
+    int received = 0;
+    auto coroutine = [&]() -> Task
+    {
+        for (int i = 0; i < 3; i++)
+            received += co_await s.next();
+    };
+    auto task = coroutine();
+
+    auto allocations_before = allocation_count.load();
+    s(1);
+    s(2);
+    s(3);
+    EXPECT_EQ(allocations_before, allocation_count.load());
+
+    EXPECT_TRUE(task.done());
+    EXPECT_EQ(6, received);
+}
+
+TEST(SignalAwaitable, changed_to_completes_once_the_predicate_accepts_a_value)
+{
+    core::Property<int> p{0};
+
+    int received = 0;
+    auto coroutine = [&]() -> Task { received = co_await p.changed_to([](int value) { return value > 10; }); };
+    auto task = coroutine();
+
+    p.set(5);
+    EXPECT_FALSE(task.done());
+    p.set(11);
+    EXPECT_TRUE(task.done());
+    EXPECT_EQ(11, received);
+
+    // Resumed waiters are no longer registered.
+    p.set(12);
+    EXPECT_EQ(11, received);
+}
+
+TEST(SignalAwaitable, waiters_are_resumed_via_their_dispatcher)
+{
+    core::EventLoopDispatcher loop{8};
+    core::Signal<int> s;
+
+    int received = 0;
+    auto coroutine = [&]() -> Task { received = co_await s.next(loop.dispatcher()); };
+    auto task = coroutine();
+
+    s(42);
+    EXPECT_FALSE(task.done());
+
+    EXPECT_EQ(1u, loop.run_once());
+    EXPECT_TRUE(task.done());
+    EXPECT_EQ(42, received);
+}
+
+TEST(SignalAwaitable, destroying_a_suspended_coroutine_unregisters_its_waiter)
+{
+    core::Signal<int> s;
+
+    bool resumed = false;
+    {
+        auto coroutine = [&]() -> Task { co_await s.next(); resumed = true; };
+        auto task = coroutine();
+        EXPECT_FALSE(task.done());
+    }
+
+    s(42);
+    EXPECT_FALSE(resumed);
+}
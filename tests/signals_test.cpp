@@ -16,14 +16,45 @@
  * Authored by: Thomas Voß <thomas.voss@canonical.com>
  */
 
+#include <core/connection_group.h>
 #include <core/signal.h>
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdlib>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <thread>
+#include <vector>
+
+namespace
+{
+std::atomic<std::size_t> allocation_count{0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+
+    if (void* p = std::malloc(size))
+        return p;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
 
 namespace
 {
@@ -190,3 +221,606 @@ TEST(Signal, installing_a_custom_dispatcher_ensures_invocation_on_correct_thread
     if (dispatcher_thread.joinable())
         dispatcher_thread.join();
 }
+
+TEST(Signal, a_slot_disconnecting_itself_during_emission_does_not_deadlock)
+{
+    core::Signal<int> s;
+
+    int invocation_count = 0;
+    core::Connection connection = s.connect([](int) {});
+    connection = s.connect(
+                [&connection, &invocation_count](int)
+                {
+                    invocation_count++;
+                    connection.disconnect();
+                });
+
+    s(42);
+    s(42);
+
+    EXPECT_EQ(1, invocation_count);
+    EXPECT_FALSE(connection.is_connected());
+}
+
+TEST(Signal, a_slot_connecting_to_the_emitting_signal_does_not_deadlock)
+{
+    core::Signal<void> s;
+
+    int invocation_count = 0;
+    std::vector<core::Connection> connections;
+    connections.push_back(s.connect(
+                [&s, &connections, &invocation_count]()
+                {
+                    invocation_count++;
+                    connections.push_back(s.connect([&invocation_count]() { invocation_count++; }));
+                }));
+
+    // Slots connected during an emission are only invoked for subsequent emissions.
+    s();
+    EXPECT_EQ(1, invocation_count);
+
+    s();
+    EXPECT_EQ(3, invocation_count);
+}
+
+TEST(Signal, concurrent_emissions_invoke_slots_on_all_emitting_threads)
+{
+    static const unsigned int thread_count = 8;
+    static const unsigned int emissions_per_thread = 10000;
+
+    core::Signal<int> s;
+
+    std::atomic<unsigned int> invocation_count{0};
+    s.connect([&invocation_count](int) { invocation_count++; });
+
+    std::vector<std::thread> emitters;
+    for (unsigned int i = 0; i < thread_count; i++)
+        emitters.emplace_back([&s]()
+        {
+            for (unsigned int j = 0; j < emissions_per_thread; j++)
+                s(j);
+        });
+
+    for (auto& emitter : emitters)
+        emitter.join();
+
+    EXPECT_EQ(thread_count * emissions_per_thread, invocation_count.load());
+}
+
+TEST(Signal, emission_via_default_dispatcher_does_not_allocate)
+{
+    static const unsigned int slot_count = 8;
+
+    core::Signal<int, double> s;
+
+    unsigned int invocation_count = 0;
+    for (unsigned int i = 0; i < slot_count; i++)
+        s.connect([&invocation_count](int, double) { invocation_count++; });
+
+    core::Signal<void> sv;
+    sv.connect([&invocation_count]() { invocation_count++; });
+
+    auto allocations_before_emission = allocation_count.load();
+    s(42, 42.);
+    sv();
+    EXPECT_EQ(allocations_before_emission, allocation_count.load());
+    EXPECT_EQ(slot_count + 1, invocation_count);
+}
+
+TEST(Signal, installing_an_empty_dispatcher_restores_immediate_invocation)
+{
+    core::Signal<int> s;
+
+    unsigned int queued_count = 0;
+    unsigned int invocation_count = 0;
+    auto connection = s.connect([&invocation_count](int) { invocation_count++; });
+
+    connection.dispatch_via([&queued_count](const std::function<void()>&) { queued_count++; });
+    s(42);
+    EXPECT_EQ(1u, queued_count);
+    EXPECT_EQ(0u, invocation_count);
+
+    connection.dispatch_via(core::Connection::Dispatcher{});
+    s(42);
+    EXPECT_EQ(1u, queued_count);
+    EXPECT_EQ(1u, invocation_count);
+}
+
+TEST(Signal, disconnecting_slots_keeps_remaining_connections_valid)
+{
+    static const unsigned int slot_count = 16;
+
+    core::Signal<unsigned int> s;
+
+    std::vector<unsigned int> invocations(slot_count, 0);
+    std::vector<core::Connection> connections;
+    for (unsigned int i = 0; i < slot_count; i++)
+        connections.push_back(s.connect([&invocations, i](unsigned int) { invocations[i]++; }));
+
+    // Disconnect every other slot, starting with the first one.
+    for (unsigned int i = 0; i < slot_count; i += 2)
+        connections[i].disconnect();
+
+    s(42);
+
+    for (unsigned int i = 0; i < slot_count; i++)
+        EXPECT_EQ(i % 2 == 0 ? 0u : 1u, invocations[i]);
+
+    // The remaining connections still refer to their respective slots.
+    for (unsigned int i = 1; i < slot_count; i += 2)
+        connections[i].disconnect();
+
+    s(42);
+
+    for (unsigned int i = 0; i < slot_count; i++)
+        EXPECT_EQ(i % 2 == 0 ? 0u : 1u, invocations[i]);
+}
+
+TEST(Signal, copies_of_a_connection_refer_to_the_same_slot)
+{
+    core::Signal<int> s;
+
+    unsigned int invocation_count = 0;
+    auto connection = s.connect([&invocation_count](int) { invocation_count++; });
+    auto copy = connection;
+
+    EXPECT_TRUE(connection.is_connected());
+    EXPECT_TRUE(copy.is_connected());
+
+    copy.disconnect();
+    s(42);
+
+    EXPECT_FALSE(connection.is_connected());
+    EXPECT_FALSE(copy.is_connected());
+    EXPECT_EQ(0u, invocation_count);
+}
+
+TEST(Signal, a_connection_outliving_its_signal_is_not_connected)
+{
+    auto signal = std::make_shared<core::Signal<int>>();
+    auto connection = signal->connect([](int) {});
+
+    EXPECT_TRUE(connection.is_connected());
+    signal.reset();
+    EXPECT_FALSE(connection.is_connected());
+}
+
+TEST(Signal, a_stale_connection_does_not_affect_a_slot_reusing_its_index)
+{
+    core::Signal<int> s;
+
+    auto stale = s.connect([](int) {});
+    stale.disconnect();
+
+    unsigned int invocation_count = 0;
+    auto connection = s.connect([&invocation_count](int) { invocation_count++; });
+
+    stale.disconnect();
+    s(42);
+
+    EXPECT_FALSE(stale.is_connected());
+    EXPECT_TRUE(connection.is_connected());
+    EXPECT_EQ(1u, invocation_count);
+}
+
+TEST(Signal, connection_handles_are_queried_and_disconnected_without_allocating)
+{
+    static const unsigned int slot_count = 8;
+
+    core::Signal<int> s;
+
+    std::vector<core::Connection> connections;
+    for (unsigned int i = 0; i < slot_count; i++)
+        connections.push_back(s.connect([](int) {}));
+
+    auto allocations_before = allocation_count.load();
+    EXPECT_TRUE(connections.front().is_connected());
+    connections.front().disconnect();
+    EXPECT_FALSE(connections.front().is_connected());
+    EXPECT_EQ(allocations_before, allocation_count.load());
+}
+
+TEST(Signal, disconnecting_a_slot_releases_its_captured_state)
+{
+    core::Signal<int> s;
+
+    std::vector<core::Connection> connections;
+    for (unsigned int i = 0; i < 3; i++)
+        connections.push_back(s.connect([](int) {}));
+
+    auto state = std::make_shared<int>(42);
+    std::weak_ptr<int> observer{state};
+
+    connections.push_back(s.connect([state](int) {}));
+    state.reset();
+    EXPECT_FALSE(observer.expired());
+
+    connections.back().disconnect();
+    EXPECT_TRUE(observer.expired());
+}
+
+TEST(Signal, disconnecting_during_an_emission_releases_captured_state_once_it_has_finished)
+{
+    core::Signal<int> s;
+
+    auto state = std::make_shared<int>(42);
+    std::weak_ptr<int> observer{state};
+
+    core::Connection c = s.connect([state](int) {});
+    state.reset();
+
+    bool expired_during_emission = true;
+    s.connect([&](int)
+    {
+        c.disconnect();
+        expired_during_emission = observer.expired();
+    });
+
+    s(42);
+    EXPECT_FALSE(expired_during_emission);
+    EXPECT_TRUE(observer.expired());
+}
+
+TEST(Signal, churning_connections_next_to_permanent_ones_reaches_a_steady_state)
+{
+    static const unsigned int permanent_count = 3;
+    static const unsigned int churn_count = 1000;
+
+    core::Signal<int> s;
+
+    unsigned int permanent_invocations = 0;
+    std::vector<core::Connection> permanent;
+    for (unsigned int i = 0; i < permanent_count; i++)
+        permanent.push_back(s.connect([&permanent_invocations](int) { permanent_invocations++; }));
+
+    std::weak_ptr<int> observers[churn_count];
+    std::size_t allocations[churn_count];
+    for (unsigned int i = 0; i < churn_count; i++)
+    {
+        auto allocations_before = allocation_count.load();
+
+        auto state = std::make_shared<int>(i);
+        observers[i] = state;
+
+        unsigned int churned_invocations = 0;
+        auto c = s.connect([state, &churned_invocations](int) { churned_invocations++; });
+        s(42);
+        c.disconnect();
+        s(42);
+
+        allocations[i] = allocation_count.load() - allocations_before;
+        EXPECT_EQ(1u, churned_invocations);
+    }
+
+    // Once the storage of the signal has been warmed up by the first iteration, every
+    // iteration only allocates its shared state and the slot: neither the slot list nor
+    // the indices of the connections grow.
+    for (unsigned int i = 2; i < churn_count; i++)
+        EXPECT_EQ(allocations[1], allocations[i]);
+    for (const auto& observer : observers)
+        EXPECT_TRUE(observer.expired());
+    EXPECT_EQ(2 * churn_count * permanent_count, permanent_invocations);
+}
+
+TEST(Signal, connect_many_connects_all_slots_in_order)
+{
+    core::Signal<int> s;
+
+    std::vector<int> invocations;
+    std::vector<core::Signal<int>::Slot> slots;
+    for (int i = 0; i < 8; i++)
+        slots.push_back([&invocations, i](int) { invocations.push_back(i); });
+
+    auto connections = s.connect_many(slots);
+    ASSERT_EQ(slots.size(), connections.size());
+
+    s(42);
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}), invocations);
+
+    connections[3].disconnect();
+    invocations.clear();
+    s(42);
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 4, 5, 6, 7}), invocations);
+}
+
+TEST(ConnectionGroup, disconnects_all_connections_across_signals)
+{
+    core::Signal<int> s1;
+    core::Signal<void> s2;
+
+    unsigned int invocation_count = 0;
+    core::ConnectionGroup group;
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        group.add(s1.connect([&invocation_count](int) { invocation_count++; }));
+        group.add(s2.connect([&invocation_count]() { invocation_count++; }));
+    }
+
+    auto survivor = s1.connect([&invocation_count](int) { invocation_count++; });
+
+    EXPECT_EQ(32u, group.size());
+    group.disconnect();
+    EXPECT_TRUE(group.empty());
+
+    s1(42);
+    s2();
+
+    EXPECT_EQ(1u, invocation_count);
+    EXPECT_TRUE(survivor.is_connected());
+}
+
+TEST(ConnectionGroup, disconnects_on_destruction_and_tolerates_dead_signals)
+{
+    core::Signal<int> s;
+
+    unsigned int invocation_count = 0;
+    {
+        auto dead = std::make_shared<core::Signal<int>>();
+
+        core::ConnectionGroup group;
+        group.add(s.connect_many({[&invocation_count](int) { invocation_count++; },
+                                  [&invocation_count](int) { invocation_count++; }}));
+        group.add(dead->connect([](int) {}));
+
+        dead.reset();
+    }
+
+    s(42);
+    EXPECT_EQ(0u, invocation_count);
+}
+
+TEST(ConnectionGroup, move_assignment_disconnects_the_connections_it_replaces)
+{
+    core::Signal<int> s;
+
+    unsigned int replaced_count = 0, moved_count = 0;
+
+    core::ConnectionGroup group;
+    group.add(s.connect([&replaced_count](int) { replaced_count++; }));
+
+    core::ConnectionGroup other;
+    other.add(s.connect([&moved_count](int) { moved_count++; }));
+
+    group = std::move(other);
+    EXPECT_EQ(1u, group.size());
+    EXPECT_TRUE(other.empty());
+
+    s(42);
+    EXPECT_EQ(0u, replaced_count);
+    EXPECT_EQ(1u, moved_count);
+}
+
+namespace
+{
+struct ArgumentCopyCounter
+{
+    ArgumentCopyCounter() = default;
+
+    ArgumentCopyCounter(const ArgumentCopyCounter&)
+    {
+        copy_count++;
+    }
+
+    ArgumentCopyCounter(ArgumentCopyCounter&&)
+    {
+    }
+
+    static unsigned int copy_count;
+};
+
+unsigned int ArgumentCopyCounter::copy_count = 0;
+}
+
+TEST(Signal, queued_invocations_copy_the_arguments_exactly_once)
+{
+    core::Signal<ArgumentCopyCounter, int> s;
+
+    int received = 0;
+    auto connection = s.connect([&received](const ArgumentCopyCounter&, int value) { received = value; });
+
+    // Slots receive their arguments as declared by the signal, by value here.
+    ArgumentCopyCounter counter;
+    ArgumentCopyCounter::copy_count = 0;
+    s(counter, 41);
+    auto immediate_copy_count = ArgumentCopyCounter::copy_count;
+
+    connection.dispatch_via([](const std::function<void()>& handler) { handler(); });
+
+    ArgumentCopyCounter::copy_count = 0;
+    s(counter, 42);
+
+    EXPECT_EQ(42, received);
+    EXPECT_EQ(immediate_copy_count + 1, ArgumentCopyCounter::copy_count);
+}
+
+TEST(Signal, queued_invocations_of_signals_without_arguments_are_delivered)
+{
+    core::Signal<void> s;
+
+    std::vector<std::function<void()>> queue;
+    unsigned int invocation_count = 0;
+    auto connection = s.connect([&invocation_count]() { invocation_count++; });
+    connection.dispatch_via([&queue](const std::function<void()>& handler) { queue.push_back(handler); });
+
+    s();
+    s();
+    EXPECT_EQ(0u, invocation_count);
+
+    for (const auto& handler : queue)
+        handler();
+    EXPECT_EQ(2u, invocation_count);
+}
+
+TEST(Signal, slots_disconnected_during_emission_are_skipped_and_released_afterwards)
+{
+    core::Signal<int> s;
+
+    auto token = std::make_shared<int>(42);
+
+    std::vector<core::Connection> connections;
+    std::vector<unsigned int> invocations(4, 0);
+    long use_count_during_emission = 0;
+
+    // The first slot disconnects all slots, including itself, the others must not be invoked anymore.
+    connections.push_back(s.connect([&, token](int)
+    {
+        invocations[0]++;
+        for (auto& connection : connections)
+            connection.disconnect();
+        use_count_during_emission = token.use_count();
+    }));
+
+    for (unsigned int i = 1; i < invocations.size(); i++)
+        connections.push_back(s.connect([&invocations, i, token](int) { invocations[i]++; }));
+
+    s(42);
+
+    EXPECT_EQ((std::vector<unsigned int>{1, 0, 0, 0}), invocations);
+    for (const auto& connection : connections)
+        EXPECT_FALSE(connection.is_connected());
+
+    // Tombstoned slots stay alive until the emission has finished, and are released in one batch afterwards.
+    EXPECT_EQ(5, use_count_during_emission);
+    EXPECT_EQ(1, token.use_count());
+}
+
+TEST(Signal, nested_emissions_defer_cleanup_to_the_outermost_emission)
+{
+    core::Signal<int> s;
+
+    auto token = std::make_shared<int>(42);
+    long use_count_after_nested_emission = 0;
+
+    core::Connection one_shot = s.connect([&one_shot, token](int) { one_shot.disconnect(); });
+    core::Connection nesting = s.connect([&](int depth)
+    {
+        if (depth == 0)
+            return;
+
+        s(depth - 1);
+        use_count_after_nested_emission = token.use_count();
+    });
+
+    s(1);
+
+    EXPECT_EQ(2, use_count_after_nested_emission);
+    EXPECT_EQ(1, token.use_count());
+    EXPECT_TRUE(nesting.is_connected());
+}
+
+TEST(Signal, slots_are_invoked_by_descending_priority)
+{
+    core::Signal<int> s;
+
+    std::vector<int> order;
+    s.connect([&order](int) { order.push_back(0); });
+    s.connect([&order](int) { order.push_back(2); }, 2);
+    s.connect([&order](int) { order.push_back(-1); }, -1);
+    s.connect([&order](int) { order.push_back(1); }, 2);
+
+    s(42);
+
+    EXPECT_EQ((std::vector<int>{2, 1, 0, -1}), order);
+}
+
+TEST(Signal, keyed_slots_only_receive_emissions_for_their_key)
+{
+    core::Signal<int, std::string> s;
+
+    std::vector<std::string> received_by_1;
+    std::vector<std::string> received_by_2;
+    unsigned int unfiltered = 0;
+
+    s.connect_keyed(1, [&received_by_1](int, const std::string& event) { received_by_1.push_back(event); });
+    auto c = s.connect_keyed(2, [&received_by_2](int, const std::string& event) { received_by_2.push_back(event); });
+    s.connect([&unfiltered](int, const std::string&) { unfiltered++; });
+
+    s(1, "a");
+    s(2, "b");
+    s(3, "c");
+
+    c.disconnect();
+    s(2, "d");
+
+    EXPECT_EQ(std::vector<std::string>{"a"}, received_by_1);
+    EXPECT_EQ(std::vector<std::string>{"b"}, received_by_2);
+    EXPECT_EQ(4u, unfiltered);
+}
+
+TEST(Signal, keyed_and_unfiltered_slots_are_interleaved_by_priority)
+{
+    core::Signal<int> s;
+
+    std::vector<std::string> order;
+    s.connect([&order](int) { order.push_back("unfiltered 1"); }, 1);
+    s.connect([&order](int) { order.push_back("unfiltered 0"); });
+    s.connect_keyed(42, [&order](int) { order.push_back("keyed 0"); });
+    s.connect_keyed(42, [&order](int) { order.push_back("keyed 2"); }, 2);
+
+    s(42);
+
+    EXPECT_EQ((std::vector<std::string>{"keyed 2", "unfiltered 1", "keyed 0", "unfiltered 0"}), order);
+}
+
+namespace
+{
+struct Subscriber
+{
+    void on_value(int value)
+    {
+        sum += value;
+    }
+
+    int sum = 0;
+};
+}
+
+TEST(Signal, weakly_referenced_targets_receive_emissions_while_alive)
+{
+    core::Signal<int> s;
+
+    auto subscriber = std::make_shared<Subscriber>();
+    auto c = s.connect(std::weak_ptr<Subscriber>{subscriber}, &Subscriber::on_value);
+
+    s(1);
+    s(2);
+    EXPECT_EQ(3, subscriber->sum);
+    EXPECT_TRUE(c.is_connected());
+}
+
+TEST(Signal, expired_targets_are_disconnected_by_the_next_emission)
+{
+    core::Signal<int> s;
+
+    std::weak_ptr<Subscriber> observer;
+    core::Connection c = [&]()
+    {
+        auto subscriber = std::make_shared<Subscriber>();
+        observer = subscriber;
+        return s.connect(subscriber, &Subscriber::on_value);
+    }();
+
+    EXPECT_TRUE(observer.expired());
+    EXPECT_TRUE(c.is_connected());
+
+    s(1);
+    EXPECT_FALSE(c.is_connected());
+}
+
+TEST(Signal, expired_keyed_targets_are_disconnected_as_well)
+{
+    core::Signal<int> s;
+
+    auto subscriber = std::make_shared<Subscriber>();
+    auto c = s.connect_keyed(1, [](int) {});
+    auto weak = s.connect(subscriber, &Subscriber::on_value);
+
+    s(1);
+    EXPECT_EQ(1, subscriber->sum);
+
+    subscriber.reset();
+    s(1);
+
+    EXPECT_TRUE(c.is_connected());
+    EXPECT_FALSE(weak.is_connected());
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/static_signal.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <functional>
+
+namespace
+{
+typedef core::InlineFunction<void(int), 16> SmallFunction;
+
+struct LargeCallable
+{
+    void operator()(int) const {}
+    std::array<char, 32> payload;
+};
+
+static_assert(SmallFunction::can_store<void(*)(int)>(), "Function pointers have to fit inline.");
+static_assert(!SmallFunction::can_store<LargeCallable>(), "Oversized callables must not fit inline.");
+}
+
+TEST(InlineFunction, invokes_stored_callable)
+{
+    int result = 0;
+    core::InlineFunction<int(int), 16> f{[&result](int value) { result = value; return value + 1; }};
+
+    EXPECT_TRUE(static_cast<bool>(f));
+    EXPECT_EQ(43, f(42));
+    EXPECT_EQ(42, result);
+}
+
+TEST(InlineFunction, copies_share_no_state)
+{
+    int counter = 0;
+    SmallFunction f{[&counter](int value) { counter += value; }};
+    SmallFunction g{f};
+    SmallFunction h;
+    h = g;
+
+    f(1); g(2); h(3);
+
+    EXPECT_EQ(6, counter);
+}
+
+TEST(InlineFunction, invoking_an_empty_instance_throws)
+{
+    SmallFunction f;
+
+    EXPECT_FALSE(static_cast<bool>(f));
+    EXPECT_THROW(f(42), std::bad_function_call);
+}
+
+TEST(StaticSignal, emission_works)
+{
+    core::StaticSignal<16, int, double> s;
+
+    int int_value = 0;
+    double double_value = 0.;
+    s.connect([&int_value, &double_value](int i, double d) { int_value = i; double_value = d; });
+
+    s(42, 42.);
+
+    EXPECT_EQ(42, int_value);
+    EXPECT_EQ(42., double_value);
+}
+
+TEST(StaticSignal, disconnect_results_in_slots_not_invoked_anymore)
+{
+    core::StaticSignal<16, int> s;
+
+    int invocation_count = 0;
+    auto connection = s.connect([&invocation_count](int) { invocation_count++; });
+    connection.disconnect();
+
+    s(42);
+
+    EXPECT_EQ(0, invocation_count);
+}
+
+TEST(StaticSignal, installing_a_dispatcher_routes_invocations)
+{
+    core::StaticSignal<16, int> s;
+
+    int value = 0;
+    std::function<void()> pending;
+    auto connection = s.connect([&value](int v) { value = v; });
+    connection.dispatch_via([&pending](const std::function<void()>& handler) { pending = handler; });
+
+    s(42);
+    EXPECT_EQ(0, value);
+
+    pending();
+    EXPECT_EQ(42, value);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2013 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ */
+
+#include <core/signal.h>
+#include <core/thread_pool_dispatcher.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPoolDispatcher, emit_and_wait_returns_after_all_slots_have_been_invoked)
+{
+    static const unsigned int slot_count = 64;
+
+    core::ThreadPoolDispatcher pool{4};
+    core::Signal<int> s;
+
+    std::atomic<unsigned int> invocation_count{0};
+    std::vector<core::Connection> connections;
+    for (unsigned int i = 0; i < slot_count; i++)
+    {
+        connections.push_back(s.connect([&invocation_count](int) { invocation_count++; }));
+        connections.back().dispatch_via(pool.dispatcher());
+    }
+
+    pool.emit_and_wait(s, 42);
+    EXPECT_EQ(slot_count, invocation_count.load());
+
+    pool.emit_and_wait(s, 43);
+    EXPECT_EQ(2 * slot_count, invocation_count.load());
+}
+
+TEST(ThreadPoolDispatcher, slots_are_invoked_on_worker_threads_in_parallel)
+{
+    static const unsigned int slot_count = 16;
+
+    core::ThreadPoolDispatcher pool{4};
+    core::Signal<void> s;
+
+    std::mutex guard;
+    std::set<std::thread::id> thread_ids;
+    std::vector<core::Connection> connections;
+    for (unsigned int i = 0; i < slot_count; i++)
+    {
+        connections.push_back(s.connect([&guard, &thread_ids]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            std::lock_guard<std::mutex> lg(guard);
+            thread_ids.insert(std::this_thread::get_id());
+        }));
+        connections.back().dispatch_via(pool.dispatcher());
+    }
+
+    pool.emit_and_wait(s);
+
+    EXPECT_LT(1u, thread_ids.size());
+}
+
+TEST(ThreadPoolDispatcher, handlers_dispatched_from_handlers_are_executed)
+{
+    std::atomic<unsigned int> invocation_count{0};
+    core::ThreadPoolDispatcher pool{2};
+
+    for (unsigned int i = 0; i < 100; i++)
+        pool.dispatch([&pool, &invocation_count]()
+        {
+            invocation_count++;
+            pool.dispatch([&invocation_count]() { invocation_count++; });
+        });
+
+    pool.wait();
+    EXPECT_EQ(200u, invocation_count.load());
+}
+
+TEST(ThreadPoolDispatcher, destruction_executes_pending_handlers)
+{
+    std::atomic<unsigned int> invocation_count{0};
+    {
+        core::ThreadPoolDispatcher pool{2};
+
+        for (unsigned int i = 0; i < 100; i++)
+            pool.dispatch([&invocation_count]() { invocation_count++; });
+    }
+
+    EXPECT_EQ(100u, invocation_count.load());
+}